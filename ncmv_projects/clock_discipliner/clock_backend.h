@@ -0,0 +1,80 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef CLOCK_BACKEND_H
+#define CLOCK_BACKEND_H
+
+#pragma once
+
+#include <time.h>
+#include <sys/timex.h>
+
+/*
+ * clock_backend
+ *
+ * The clock operations the discipliner performs, with the same
+ * arguments and return conventions as clock_gettime / clock_settime /
+ * clock_adjtime. Tests inject simulated_clock (clock_simulator.h)
+ * instead of touching the system clock.
+ */
+
+class clock_backend
+{
+public:
+    virtual ~clock_backend() {}
+
+    virtual int gettime(struct timespec* ts) = 0;
+    virtual int settime(const struct timespec* ts) = 0;
+    virtual int adjtime(struct timex* tx) = 0;
+};
+
+/*
+ * The real CLOCK_REALTIME; setting it requires CAP_SYS_TIME
+ */
+class realtime_clock_backend : public clock_backend
+{
+public:
+    int gettime(struct timespec* ts) override
+    {
+        return clock_gettime(CLOCK_REALTIME, ts);
+    }
+
+    int settime(const struct timespec* ts) override
+    {
+        return clock_settime(CLOCK_REALTIME, ts);
+    }
+
+    int adjtime(struct timex* tx) override
+    {
+        return clock_adjtime(CLOCK_REALTIME, tx);
+    }
+};
+
+inline clock_backend& default_clock_backend()
+{
+    static realtime_clock_backend backend;
+    return backend;
+}
+
+#endif // CLOCK_BACKEND_H
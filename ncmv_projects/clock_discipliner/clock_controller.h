@@ -0,0 +1,146 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef CLOCK_CONTROLLER_H
+#define CLOCK_CONTROLLER_H
+
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+/*
+ * PI clock controller (FLL acquisition, then PLL tracking)
+ *
+ * - Acquisition: for the first acquisition_s seconds no correction is
+ *   made; a least-squares fit of the offsets gives the initial
+ *   frequency error
+ * - Tracking: the integral term learns the frequency (applied with
+ *   ADJ_FREQUENCY); the proportional term is the offset itself, handed
+ *   to the kernel with ADJ_OFFSET and drained at 1 / phase_time_constant
+ *   per second
+ *
+ * Offsets are "source minus system clock": positive means the clock is
+ * behind and must speed up.
+ */
+
+struct pi_config
+{
+    double phase_time_constant_s = 16.0;     /* kernel drain time, rounded to a power of two >= 4 */
+    double frequency_time_constant_s = 32.0; /* integral time; 2x the phase constant is critically damped */
+    int64_t acquisition_s = 8;               /* FLL window before the loop closes */
+};
+
+class pi_controller
+{
+public:
+    struct correction
+    {
+        bool active;         /* false while acquiring: leave the clock alone */
+        double frequency_ppb;
+        double phase_ns;
+    };
+
+    explicit pi_controller(const pi_config& config = pi_config())
+        : cfg(config),
+          frequency(0.0),
+          locked(false),
+          elapsed_s(0.0)
+    {
+        reset_fit();
+    }
+
+    /* One discipline interval: filtered offset and seconds since the last update */
+    correction update(double offset_ns, double dt_s)
+    {
+        if (!locked)
+        {
+            elapsed_s += dt_s;
+            fit_n += 1.0;
+            fit_t += elapsed_s;
+            fit_x += offset_ns;
+            fit_tt += elapsed_s * elapsed_s;
+            fit_tx += elapsed_s * offset_ns;
+
+            if (elapsed_s < (double)cfg.acquisition_s || fit_n < 2.0)
+            {
+                return correction{false, frequency, 0.0};
+            }
+
+            /* Offset slope in ns/s is the correction needed, in ppb */
+            double denominator = fit_n * fit_tt - fit_t * fit_t;
+            if (denominator > 0.0)
+            {
+                frequency += (fit_n * fit_tx - fit_t * fit_x) / denominator;
+            }
+            locked = true;
+        }
+        else
+        {
+            frequency += offset_ns * dt_s / (cfg.frequency_time_constant_s * cfg.frequency_time_constant_s);
+        }
+
+        return correction{true, frequency, offset_ns};
+    }
+
+    /* After a step the offset history is meaningless; re-acquire unless already locked */
+    void on_step()
+    {
+        if (!locked)
+        {
+            reset_fit();
+        }
+    }
+
+    bool is_locked() const { return locked; }
+    double frequency_ppb() const { return frequency; }
+
+    /* ADJ_TIMECONST value (nanosecond mode) giving the configured phase time constant */
+    long kernel_time_constant() const
+    {
+        long tc = lround(log2(cfg.phase_time_constant_s)) - 2;
+        return tc < 0 ? 0 : (tc > 10 ? 10 : tc);
+    }
+
+private:
+    pi_config cfg;
+    double frequency;
+    bool locked;
+
+    /* Acquisition fit sums */
+    double elapsed_s;
+    double fit_n;
+    double fit_t;
+    double fit_x;
+    double fit_tt;
+    double fit_tx;
+
+    void reset_fit()
+    {
+        elapsed_s = 0.0;
+        fit_n = fit_t = fit_x = fit_tt = fit_tx = 0.0;
+    }
+};
+
+#endif // CLOCK_CONTROLLER_H
@@ -27,152 +27,689 @@ SOFTWARE.
 
 #pragma once
 
+#include "discipline_policies.h"
+#include "shared_state.h"
+#include "stability_stats.h"
+#include "trace_log.h"
+
 #include <time.h>
 #include <sys/timex.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <math.h>
 
 /*
  * ClockDiscipliner
  *
  * - Collects jittery 10Hz Clock timestamps
+ * - Optionally pre-filters offsets (median, Hampel or minimum delay)
  * - Filters offset using EWMA
- * - Disciplines CLOCK_REALTIME at 1Hz
+ * - Disciplines CLOCK_REALTIME at 1Hz, either by slewing the filtered
+ *   offset (EWMA_SLEW) or with a PI frequency loop (PI_LOOP)
+ * - Optionally stretches that interval up to 2^max_exponent seconds
+ *   while the loop is quiet (poll_config)
  *
  * This class never directly sets system time on every Clock message.
  * It behaves like a simplified NTP clock discipline algorithm.
+ *
+ * When samples stop for holdover.timeout_s (noticed by check_source()),
+ * it enters holdover: phase corrections stop and the last learned
+ * frequency is held while the predicted error grows. When the source
+ * returns it re-acquires, stepping only if that predicted error had grown
+ * past the step threshold and slewing otherwise.
+ *
+ * Steps are relative and atomic in the kernel (ADJ_SETOFFSET); the
+ * filters keep their history, shifted by the step, and last_step() holds
+ * the offsets around the latest one and how long the syscall took.
+ *
+ * Filtering, the step/slew decision, the clock_adjtime() encoding and the
+ * clock itself are the Filter, Controller, Actuator and Clock policies
+ * (discipline_policies.h). clock_discipliner is the default composition
+ * on CLOCK_REALTIME; backend_clock_discipliner takes any clock_backend,
+ * such as the simulator's.
+ * Samples and clock actions can be recorded to a binary trace_log, which
+ * unlike the text log never blocks the caller, and the discipline state
+ * can be published to other processes through a shared_state_publisher.
  */
 
-class clock_discipliner
+enum class discipline_state
+{
+    TRACKING,    /* samples arriving, normal discipline */
+    HOLDOVER,    /* source lost: frequency held, no phase corrections */
+    REACQUIRING  /* source back: converging again, stepping only if holdover allowed it */
+};
+
+/* The latest clock step */
+struct step_record
+{
+    int64_t pre_offset_ns;  /* filtered offset that triggered it */
+    int64_t step_ns;        /* applied; 0 if the syscall failed */
+    int64_t post_offset_ns; /* first raw sample after it, once post_measured */
+    bool post_measured;
+    uint64_t stale_samples; /* received before it but delivered after, dropped */
+    uint64_t latency_ns;    /* clock_adjtime(ADJ_SETOFFSET), CLOCK_MONOTONIC */
+    int error;              /* errno if it failed */
+};
+
+template <class Filter = ewma_filter, class Controller = threshold_controller, class Actuator = kernel_actuator,
+          class Clock = realtime_clock>
+class basic_clock_discipliner
 {
 public:
-    clock_discipliner()
-        : ewma_offset_ns(0),
-          ewma_alpha(0.2),
+    typedef Filter filter_type;
+    typedef Controller controller_type;
+    typedef Actuator actuator_type;
+    typedef Clock clock_type;
+
+    explicit basic_clock_discipliner(const Clock& clock_policy = Clock(),
+                                     const discipline_config& config = discipline_config())
+        : clock(clock_policy),
+          log(stdout),
+          trace(nullptr),
+          publisher(nullptr),
+          filter(config),
+          controller(config),
+          stats(config.stability),
+          stats_enabled(config.stability.octaves > 0),
+          last_discipline_sec(0),
+          poll(config.poll),
+          max_poll_exponent(controller.max_poll_exponent()),
+          poll_exponent(config.poll.adaptive ? config.poll.min_exponent : 0),
+          poll_counter(0),
+          clock_jitter_ns(0.0),
+          last_decision_offset_ns(0),
+          holdover(config.holdover),
+          state(discipline_state::TRACKING),
+          last_sample_ns(0),
+          holdover_offset_ns(0),
+          status_saved(false),
+          saved_status(0),
+          reacquire_may_step(true),
+          reacquire_until_sec(0),
+          kernel_frequency_ppb(0.0),
           sample_count(0),
-          last_discipline_sec(0)
+          step_count(0),
+          step_guard_ns(0),
+          last(step_record())
     {}
 
+    /*
+     * Where discipline messages go; nullptr silences them
+     */
+    void set_log(FILE* stream)
+    {
+        log = stream;
+    }
+
+    /*
+     * Binary trace of every sample and clock action; nullptr disables it
+     */
+    void set_trace(trace_log* sink)
+    {
+        trace = sink;
+    }
+
+    /*
+     * Shared-memory page updated after every discipline decision and
+     * holdover check; nullptr disables it
+     */
+    void set_publisher(shared_state_publisher* page)
+    {
+        publisher = page;
+    }
+
     /*
      * Called when a GNSS message arrives.
      *
      * time_source_ms:
      *   Absolute GNSS time in milliseconds since epoch
+     *
+     * The receive time is read from the clock here, so any delay in
+     * delivering the message counts as offset; prefer on_time_sample().
      */
     void on_time_source_tick(uint64_t time_source_ms)
     {
         struct timespec ts;
-        clock_gettime(CLOCK_REALTIME, &ts);
+        clock.gettime(&ts);
 
-        uint64_t system_time_ms = ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
-        int64_t offset_ms = (int64_t)time_source_ms - (int64_t)system_time_ms;
-        int64_t offset_ns = offset_ms * 1000000LL;
+        on_time_sample(time_source_ms * 1000000ULL, ts);
+    }
 
-        update_ewma(offset_ns);
+    /*
+     * Called with a nanosecond source time and the local clock reading
+     * taken when the message was received (SO_TIMESTAMPNS, or the reader
+     * thread right after the read).
+     *
+     * source_ns:
+     *   Absolute source time in nanoseconds since epoch
+     * receive_ns:
+     *   Local clock, nanoseconds since epoch, at reception
+     */
+    void on_time_sample(uint64_t source_ns, uint64_t receive_ns)
+    {
+        on_offset_sample(offset_between(source_ns, receive_ns), receive_ns);
+    }
 
-        discipline_if_needed(ts.tv_sec);
+    void on_time_sample(uint64_t source_ns, const struct timespec& received)
+    {
+        on_time_sample(source_ns, (uint64_t)received.tv_sec * 1000000000ULL + (uint64_t)received.tv_nsec);
+    }
+
+    /*
+     * Called with an offset measured elsewhere, e.g. the combined offset
+     * of a source_selector.
+     *
+     * offset_ns:
+     *   Source minus local clock
+     * receive_ns:
+     *   Local clock, nanoseconds since epoch, when it was measured
+     *
+     * Returns how far the clock was stepped, 0 if it was not; a
+     * source_selector must be told with on_step().
+     *
+     * Samples received before the latest step but delivered after it
+     * (queued, as discipline_thread does) were measured against the old
+     * clock and are dropped.
+     */
+    int64_t on_offset_sample(int64_t offset_ns, uint64_t receive_ns)
+    {
+        if (step_guard_ns != 0)
+        {
+            if (receive_ns < step_guard_ns)
+            {
+                last.stale_samples++;
+                return 0;
+            }
+            step_guard_ns = 0;
+        }
+
+        if (state == discipline_state::HOLDOVER)
+        {
+            leave_holdover(offset_ns, receive_ns);
+        }
+        last_sample_ns = receive_ns;
+        sample_count++;
+
+        if (step_count > 0 && !last.post_measured)
+        {
+            last.post_offset_ns = offset_ns;
+            last.post_measured = true;
+            if (log != nullptr)
+            {
+                fprintf(log, "[step] first offset after step = %.3f ms\n", offset_ns / 1e6);
+            }
+        }
+
+        int64_t filtered_ns = filter.add(offset_ns);
+        if (trace != nullptr)
+        {
+            trace->record(TRACE_SAMPLE, offset_ns, filtered_ns);
+        }
+        if (stats_enabled)
+        {
+            stats.add(filtered_ns);
+        }
+
+        return discipline_if_needed((time_t)(receive_ns / 1000000000ULL));
+    }
+
+    /*
+     * Call periodically, e.g. once per second; discipline_thread does so
+     * on every wake. Enters holdover once no sample has arrived for
+     * holdover.timeout_s.
+     */
+    void check_source()
+    {
+        if (state == discipline_state::HOLDOVER)
+        {
+            publish_state(); /* the error bound keeps growing */
+            return;
+        }
+        if (filter.empty() || holdover.timeout_s <= 0.0)
+        {
+            return;
+        }
+
+        uint64_t now_ns = clock_now_ns();
+        if (now_ns > last_sample_ns && (double)(now_ns - last_sample_ns) > holdover.timeout_s * 1e9)
+        {
+            enter_holdover(now_ns);
+            publish_state();
+        }
+    }
+
+    discipline_state current_state() const
+    {
+        return state;
+    }
+
+    /* Predicted time error in holdover, 0 otherwise */
+    double holdover_error_ns()
+    {
+        return state == discipline_state::HOLDOVER ? predicted_error_ns(clock_now_ns()) : 0.0;
+    }
+
+    /*
+     * ADEV / TDEV / MTIE of the pre-filtered offsets; empty unless
+     * stability.octaves is set (it is 0, off, by default). Not
+     * synchronized: read it from the thread that feeds samples, or once
+     * that has stopped.
+     */
+    const stability_stats& stability() const
+    {
+        return stats;
+    }
+
+    /* Seconds between discipline decisions, currently */
+    int64_t poll_interval_s() const
+    {
+        return 1LL << poll_exponent;
+    }
+
+    /* Same threading rule as stability() */
+    const step_record& last_step() const
+    {
+        return last;
     }
 
 private:
-    /* Exponentially weighted moving average of offset */
-    int64_t ewma_offset_ns;
-    const double ewma_alpha;
+    Clock clock;
+    FILE* log;
+    trace_log* trace;
+    shared_state_publisher* publisher;
+
+    Filter filter;
+    Controller controller;
+    Actuator actuator;
+    stability_stats stats;
+    const bool stats_enabled;
 
-    int64_t sample_count;
     time_t last_discipline_sec;
 
-    void update_ewma(int64_t offset_ns)
+    const poll_config poll;
+    const int max_poll_exponent;
+    int poll_exponent;
+    int poll_counter;
+    double clock_jitter_ns;
+    int64_t last_decision_offset_ns;
+
+    const holdover_config holdover;
+    discipline_state state;
+    uint64_t last_sample_ns;
+    int64_t holdover_offset_ns; /* filtered offset when the source was lost */
+    bool status_saved;          /* saved_status was read; restore it after holdover */
+    int saved_status;           /* kernel status to restore after holdover */
+    bool reacquire_may_step;
+    time_t reacquire_until_sec;
+
+    double kernel_frequency_ppb; /* as reported by the last clock_adjtime() */
+    uint64_t sample_count;       /* published; stats only counts with statistics on */
+    uint64_t step_count;
+    uint64_t step_guard_ns; /* samples received before this predate the last step */
+    step_record last;
+
+    /*
+     * source - receive without overflow: both are ~1.8e18, so the
+     * difference is taken unsigned and saturated to +/-INT64_MAX
+     */
+    static int64_t offset_between(uint64_t source_ns, uint64_t receive_ns)
     {
-        if (sample_count == 0)
+        if (source_ns >= receive_ns)
         {
-            ewma_offset_ns = offset_ns;
+            uint64_t ahead = source_ns - receive_ns;
+            return ahead > (uint64_t)INT64_MAX ? INT64_MAX : (int64_t)ahead;
         }
-        else
+
+        uint64_t behind = receive_ns - source_ns;
+        return behind > (uint64_t)INT64_MAX ? -INT64_MAX : -(int64_t)behind;
+    }
+
+    uint64_t trace_start() const
+    {
+        return trace != nullptr ? trace_log::monotonic_ns() : 0;
+    }
+
+    /* Record a clock syscall; call straight after it so errno is still its own */
+    void trace_action(trace_event event, int64_t value1, int64_t value2, uint64_t started_ns, int ret)
+    {
+        if (trace != nullptr)
         {
-            ewma_offset_ns = (int64_t)((1.0 - ewma_alpha) * ewma_offset_ns + ewma_alpha * offset_ns);
+            int error = ret < 0 ? errno : 0;
+            trace->record(event, value1, value2, (int64_t)(trace_log::monotonic_ns() - started_ns), error);
         }
-        sample_count++;
     }
 
     /*
-     * Discipline system clock at most once per second
+     * Discipline system clock at most once per poll interval (a second
+     * unless adaptive); returns the step applied, if any
      */
-    void discipline_if_needed(time_t current_sec)
+    int64_t discipline_if_needed(time_t current_sec)
     {
-        if (current_sec == last_discipline_sec)
+        const int64_t offset_ns = filter.offset();
+        const int64_t step_threshold_ns = controller.step_threshold_ns();
+        int64_t abs_offset_ns = offset_ns >= 0 ? offset_ns : -offset_ns;
+
+        /* A clock stepped back makes current_sec smaller: decide now */
+        if (current_sec >= last_discipline_sec && current_sec - last_discipline_sec < poll_interval_s() &&
+            (current_sec == last_discipline_sec || abs_offset_ns <= step_threshold_ns))
         {
-            return;
+            return 0;
         }
 
+        double interval_s = last_discipline_sec != 0 ? (double)(current_sec - last_discipline_sec) : 1.0;
         last_discipline_sec = current_sec;
 
-        int64_t abs_offset_ns = ewma_offset_ns >= 0 ? ewma_offset_ns : -ewma_offset_ns;
+        if (trace != nullptr)
+        {
+            trace->record(TRACE_FILTERED, offset_ns);
+        }
+        if (log != nullptr)
+        {
+            fprintf(log, "[discipline] filtered offset = %.3f ms\n", offset_ns / 1e6);
+        }
+
+        bool may_step = true;
+        if (state == discipline_state::REACQUIRING)
+        {
+            if (abs_offset_ns <= step_threshold_ns || current_sec >= reacquire_until_sec)
+            {
+                state = discipline_state::TRACKING;
+            }
+            else
+            {
+                may_step = reacquire_may_step;
+            }
+        }
+
+        discipline_action action = controller.decide(offset_ns, interval_s, may_step);
+        switch (action.kind)
+        {
+            case discipline_action_kind::STEP:
+            {
+                int64_t stepped_ns = step_clock(action.offset_ns);
+                if (stepped_ns != 0)
+                {
+                    controller.on_step();
+                    reset_poll();
+                }
+                publish_state();
+                return stepped_ns;
+            }
+
+            case discipline_action_kind::SLEW:
+                slew_clock(action.offset_ns);
+                break;
+
+            case discipline_action_kind::STEER:
+                steer_clock(action);
+                break;
+
+            case discipline_action_kind::NONE:
+            default:
+                break;
+        }
+        adapt_poll();
+        publish_state();
+        return 0;
+    }
+
+    void adapt_poll()
+    {
+        if (!poll.adaptive)
+        {
+            return;
+        }
 
-        printf("[discipline] filtered offset = %.3f ms\n", ewma_offset_ns / 1e6);
+        const int64_t offset_ns = filter.offset();
+        double change = (double)(offset_ns - last_decision_offset_ns);
+        last_decision_offset_ns = offset_ns;
+        clock_jitter_ns = sqrt(clock_jitter_ns * clock_jitter_ns +
+                               (change * change - clock_jitter_ns * clock_jitter_ns) / 4.0);
 
-        if (abs_offset_ns > 3LL * 1000000LL) // > 3 ms
+        double gate_ns = poll.gate * fmax(clock_jitter_ns, poll.min_jitter_ns);
+        bool quiet = fabs((double)offset_ns) < gate_ns && controller.is_locked();
+        if (quiet)
         {
-            step_clock();
+            poll_counter += poll_exponent + 1;
         }
         else
         {
-            slew_clock();
+            poll_counter -= 2 * (poll_exponent + 1);
+        }
+
+        int exponent = poll_exponent;
+        if (poll_counter >= poll.limit)
+        {
+            exponent = poll_exponent < max_poll_exponent ? poll_exponent + 1 : poll_exponent;
+            poll_counter = 0;
         }
+        else if (poll_counter <= -poll.limit)
+        {
+            exponent = poll_exponent > poll.min_exponent ? poll_exponent - 1 : poll_exponent;
+            poll_counter = 0;
+        }
+
+        if (exponent != poll_exponent && log != nullptr)
+        {
+            fprintf(log, "[poll] interval %lld s -> %lld s\n", (long long)poll_interval_s(), 1LL << exponent);
+        }
+        poll_exponent = exponent;
     }
 
-    /*
-     * Hard step: only used for very large errors
-     */
-    void step_clock()
+    void reset_poll()
+    {
+        if (poll.adaptive)
+        {
+            poll_exponent = poll.min_exponent;
+            poll_counter = 0;
+        }
+    }
+
+    void publish_state()
+    {
+        if (publisher == nullptr)
+        {
+            return;
+        }
+
+        disciplined_state s;
+        s.update_ns = clock_now_ns();
+        s.offset_ns = filter.offset();
+        s.frequency_ppb = controller.steers_frequency() ? controller.frequency_ppb() : kernel_frequency_ppb;
+        s.error_bound_ns = state == discipline_state::HOLDOVER ? predicted_error_ns(s.update_ns) : 0.0;
+        s.state = (uint32_t)state;
+        s.samples = sample_count;
+        s.steps = step_count;
+        publisher->publish(s);
+    }
+
+    uint64_t clock_now_ns()
     {
         struct timespec ts;
-        clock_gettime(CLOCK_REALTIME, &ts);
+        clock.gettime(&ts);
+        return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    }
 
-        int64_t new_ns = ts.tv_sec * 1000000000LL + ts.tv_nsec + ewma_offset_ns;
+    double predicted_error_ns(uint64_t now_ns) const
+    {
+        double t = now_ns > last_sample_ns ? (double)(now_ns - last_sample_ns) / 1e9 : 0.0;
+        return fabs((double)holdover_offset_ns) + holdover.frequency_uncertainty_ppb * t +
+               holdover.wander_ppb * t * sqrt(t) / sqrt(3.0);
+    }
 
-        struct timespec new_ts;
-        new_ts.tv_sec = new_ns / 1000000000LL;
-        new_ts.tv_nsec = new_ns % 1000000000LL;
+    /*
+     * Stop phase corrections and hold the frequency: the PI loop's learned
+     * value, or whatever the kernel PLL had learned. ADJ_OFFSET 0 cancels
+     * the kernel's pending phase correction, which was based on samples
+     * that can no longer be checked.
+     */
+    void enter_holdover(uint64_t now_ns)
+    {
+        state = discipline_state::HOLDOVER;
+        holdover_offset_ns = filter.offset();
+        last_discipline_sec = 0;
 
-        int ret = clock_settime(CLOCK_REALTIME, &new_ts);
+        uint64_t started_ns = trace_start();
+        int ret = actuator.hold(clock, controller.steers_frequency(), controller.frequency_ppb(), status_saved,
+                                saved_status, kernel_frequency_ppb);
+        int error = ret < 0 ? errno : 0;
+        trace_action(TRACE_HOLDOVER, holdover_offset_ns, (int64_t)((now_ns - last_sample_ns) / 1000000ULL), started_ns, ret);
+        if (!status_saved && !controller.steers_frequency() && log != nullptr)
+        {
+            fprintf(log, "[holdover] could not read the clock status; it will not be restored\n");
+        }
         if (ret < 0)
         {
-            perror("[step] clock_settime failed");
+            if (log != nullptr)
+            {
+                fprintf(log, "[holdover] clock_adjtime failed: %s\n", strerror(error));
+            }
         }
-        else
+        else if (log != nullptr)
+        {
+            fprintf(log, "[holdover] no sample for %.1f s: holding frequency, last offset %.3f ms\n",
+                    (now_ns - last_sample_ns) / 1e9, holdover_offset_ns / 1e6);
+        }
+    }
+
+    /*
+     * Source is back. Forget the pre-holdover filter state so the first
+     * fresh offset is not averaged with stale ones, and decide once
+     * whether re-acquisition may step: only if the predicted error has
+     * outgrown the step threshold. Otherwise even a large first offset is
+     * slewed, for up to holdover.reacquire_s.
+     */
+    void leave_holdover(int64_t offset_ns, uint64_t receive_ns)
+    {
+        double predicted_ns = predicted_error_ns(receive_ns);
+
+        state = discipline_state::REACQUIRING;
+        reacquire_may_step = predicted_ns > (double)controller.step_threshold_ns();
+        reacquire_until_sec = (time_t)(receive_ns / 1000000000ULL) + (time_t)holdover.reacquire_s;
+        filter.restart();
+        reset_poll();
+
+        if (!controller.steers_frequency() && status_saved)
         {
-            printf("[step] clock stepped by %.3f ms\n", ewma_offset_ns / 1e6);
+            actuator.restore(clock, saved_status);
         }
 
-        ewma_offset_ns = 0;
+        if (trace != nullptr)
+        {
+            trace->record(TRACE_REACQUIRE, offset_ns, (int64_t)predicted_ns);
+        }
+        if (log != nullptr)
+        {
+            fprintf(log, "[holdover] source back after %.1f s: offset %.3f ms, predicted error %.3f ms, %s\n",
+                    (receive_ns - last_sample_ns) / 1e9, offset_ns / 1e6, predicted_ns / 1e6,
+                    reacquire_may_step ? "may step" : "slewing");
+        }
     }
 
     /*
-     * Slew clock using clock_adjtime()
+     * Hard step: only used for very large errors. Returns the step
+     * applied, 0 if it failed.
+     *
+     * Units follow the controller's: PI_LOOP already runs the kernel in
+     * ADJ_NANO, EWMA_SLEW in microseconds, where the step is rounded to
+     * a microsecond.
+     *
+     * The filters are re-seeded rather than cleared: the EWMA and the
+     * pre-filter history move by the step, and any rounding residue
+     * stays in the EWMA to be slewed.
      */
-    void slew_clock()
+    int64_t step_clock(int64_t offset_ns)
     {
-        struct timex tx;
-        memset(&tx, 0, sizeof(tx));
+        const bool nano = controller.nanosecond_units();
+        const int64_t unit_ns = nano ? 1 : 1000;
+        int64_t step_ns = offset_ns / unit_ns * unit_ns;
+
+        uint64_t before_ns = clock_now_ns();
+        uint64_t started_ns = trace_log::monotonic_ns();
+        int ret = actuator.step(clock, step_ns, nano);
+        int error = ret < 0 ? errno : 0;
+        uint64_t latency_ns = trace_log::monotonic_ns() - started_ns;
+        trace_action(TRACE_STEP, ret < 0 ? 0 : step_ns, offset_ns, started_ns, ret);
+
+        last = step_record();
+        last.pre_offset_ns = offset_ns;
+        last.latency_ns = latency_ns;
+        last.error = error;
+
+        if (ret < 0)
+        {
+            if (log != nullptr)
+            {
+                fprintf(log, "[step] clock_adjtime(ADJ_SETOFFSET) failed: %s\n", strerror(error));
+            }
+            return 0;
+        }
+
+        last.step_ns = step_ns;
+        step_count++;
+        filter.shift(-step_ns);
 
         /*
-         * offset is in microseconds
-         * kernel slews clock gradually
+         * Samples received before the step are stale. Stepping forward,
+         * they read earlier than the step instant now does; stepping
+         * back, the clock repeats |step| of readings, so everything up to
+         * the old reading of the instant goes, losing at most |step| of
+         * fresh samples.
          */
-        tx.modes = ADJ_OFFSET;
-        tx.offset = ewma_offset_ns / 1000;
+        step_guard_ns = before_ns + (step_ns > 0 ? (uint64_t)step_ns : 0);
+
+        if (log != nullptr)
+        {
+            fprintf(log, "[step] clock stepped by %.3f ms in %.1f us\n", step_ns / 1e6, latency_ns / 1e3);
+        }
+        return step_ns;
+    }
 
-        int ret = clock_adjtime(CLOCK_REALTIME, &tx);
+    void slew_clock(int64_t offset_ns)
+    {
+        uint64_t started_ns = trace_start();
+        int ret = actuator.slew(clock, offset_ns, kernel_frequency_ppb);
+        int error = ret < 0 ? errno : 0;
+        trace_action(TRACE_SLEW, offset_ns, 0, started_ns, ret);
         if (ret < 0)
         {
-            perror("[slew] clock_adjtime failed");
+            if (log != nullptr)
+            {
+                fprintf(log, "[slew] clock_adjtime failed: %s\n", strerror(error));
+            }
         }
-        else
+        else if (log != nullptr)
+        {
+            fprintf(log, "[slew] clock slewed by %.3f ms\n", offset_ns / 1e6);
+        }
+    }
+
+    void steer_clock(const discipline_action& action)
+    {
+        uint64_t started_ns = trace_start();
+        int ret = actuator.steer(clock, action, kernel_frequency_ppb);
+        int error = ret < 0 ? errno : 0;
+        trace_action(TRACE_STEER, (int64_t)action.phase_ns, (int64_t)(action.frequency_ppb * 1000.0), started_ns, ret);
+        if (ret < 0)
+        {
+            if (log != nullptr)
+            {
+                fprintf(log, "[pll] clock_adjtime failed: %s\n", strerror(error));
+            }
+        }
+        else if (log != nullptr)
         {
-            printf("[slew] clock slewed by %.3f ms\n", ewma_offset_ns / 1e6);
+            fprintf(log, "[pll] frequency %.3f ppm, offset %.3f ms\n", action.frequency_ppb / 1e3, action.phase_ns / 1e6);
         }
     }
 };
 
-#endif // CLOCK_DISCIPLINER_H
\ No newline at end of file
+/* CLOCK_REALTIME, no virtual calls: what the daemon runs */
+typedef basic_clock_discipliner<> clock_discipliner;
+
+/* Any clock_backend, e.g. the simulator's simulated_clock */
+typedef basic_clock_discipliner<ewma_filter, threshold_controller, kernel_actuator, backend_clock> backend_clock_discipliner;
+
+#endif // CLOCK_DISCIPLINER_H
@@ -0,0 +1,370 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef CLOCK_SIMULATOR_H
+#define CLOCK_SIMULATOR_H
+
+#pragma once
+
+#include "clock_backend.h"
+
+#include <stdint.h>
+#include <math.h>
+#include <errno.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+/*
+ * Simulated system clock
+ *
+ * - "True" time is driven by clock_simulator; the system clock runs
+ *   ahead or behind it by offset_ns()
+ * - The oscillator has a constant frequency error plus random-walk
+ *   wander, updated once per second
+ * - clock_adjtime follows the Linux NTP kernel code (kernel/time/ntp.c):
+ *   ADJ_OFFSET in PLL mode sets a phase error that is drained by
+ *   1 / 2^(SHIFT_PLL + time_constant) each second and nudges the kernel
+ *   frequency; ADJ_FREQUENCY, ADJ_TIMECONST, ADJ_STATUS and
+ *   ADJ_SETOFFSET behave as on Linux
+ */
+
+struct clock_model
+{
+    double initial_offset_ns = 0.0;   /* system clock minus true time at start */
+    double frequency_error_ppb = 0.0; /* constant oscillator error, 1000 ppb = 1 ppm */
+    double wander_ppb = 0.0;          /* std-dev of the per-second random-walk frequency step */
+    bool kernel_pll = true;           /* STA_PLL set, as left behind by an NTP daemon */
+    uint64_t seed = 1;
+};
+
+class simulated_clock : public clock_backend
+{
+public:
+    simulated_clock(const clock_model& model, int64_t start_true_ns)
+        : now_ns(start_true_ns),
+          next_second_ns(start_true_ns + NSEC_PER_SEC),
+          offset(model.initial_offset_ns),
+          oscillator_ppb(model.frequency_error_ppb),
+          wander_ppb(model.wander_ppb),
+          rng(model.seed),
+          status(model.kernel_pll ? STA_PLL : STA_UNSYNC),
+          time_constant(2),
+          time_offset_ns(0.0),
+          time_freq_ppb(0.0),
+          slew_ppb(0.0),
+          time_reftime(0),
+          gettime_calls(0),
+          settime_calls(0),
+          adjtime_calls(0),
+          setoffset_calls(0)
+    {
+        time_reftime = system_seconds();
+    }
+
+    /* Advance true time; only moves forward */
+    void advance_to(int64_t true_ns)
+    {
+        while (true_ns >= next_second_ns)
+        {
+            integrate(next_second_ns);
+            second_overflow();
+            next_second_ns += NSEC_PER_SEC;
+        }
+        integrate(true_ns);
+    }
+
+    int64_t true_ns() const { return now_ns; }
+
+    /* System clock minus true time */
+    double offset_ns() const { return offset; }
+
+    /* Current rate error of the system clock: oscillator plus kernel corrections */
+    double frequency_ppb() const { return oscillator_ppb + time_freq_ppb + slew_ppb; }
+
+    double oscillator_frequency_ppb() const { return oscillator_ppb; }
+    double kernel_frequency_ppb() const { return time_freq_ppb; }
+
+    uint64_t gettime_count() const { return gettime_calls; }
+    uint64_t settime_count() const { return settime_calls; }
+    uint64_t adjtime_count() const { return adjtime_calls; }
+
+    /* clock_settime() calls plus successful ADJ_SETOFFSET steps */
+    uint64_t step_count() const { return settime_calls + setoffset_calls; }
+
+    int gettime(struct timespec* ts) override
+    {
+        gettime_calls++;
+        int64_t system_ns = now_ns + (int64_t)floor(offset);
+        ts->tv_sec = system_ns / NSEC_PER_SEC;
+        ts->tv_nsec = system_ns % NSEC_PER_SEC;
+        return 0;
+    }
+
+    int settime(const struct timespec* ts) override
+    {
+        settime_calls++;
+        if (ts->tv_nsec < 0 || ts->tv_nsec >= NSEC_PER_SEC)
+        {
+            errno = EINVAL;
+            return -1;
+        }
+        offset = (double)(ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec - now_ns);
+        return 0;
+    }
+
+    int adjtime(struct timex* tx) override
+    {
+        adjtime_calls++;
+        int modes = tx->modes;
+
+        if (modes & ADJ_SETOFFSET)
+        {
+            bool nano = (modes & ADJ_NANO) != 0;
+            if (tx->time.tv_usec < 0 || tx->time.tv_usec >= (nano ? NSEC_PER_SEC : 1000000))
+            {
+                errno = EINVAL;
+                return -1;
+            }
+            offset += (double)tx->time.tv_sec * NSEC_PER_SEC + (double)tx->time.tv_usec * (nano ? 1 : 1000);
+            setoffset_calls++;
+        }
+
+        if (modes & ADJ_STATUS)
+        {
+            if (!(status & STA_PLL) && (tx->status & STA_PLL))
+            {
+                time_reftime = system_seconds();
+            }
+            status = (status & STA_RONLY) | (tx->status & ~STA_RONLY);
+        }
+
+        if (modes & ADJ_NANO)
+        {
+            status |= STA_NANO;
+        }
+        if (modes & ADJ_MICRO)
+        {
+            status &= ~STA_NANO;
+        }
+
+        if (modes & ADJ_FREQUENCY)
+        {
+            time_freq_ppb = clamp_frequency(tx->freq * 1000.0 / 65536.0);
+        }
+
+        if (modes & ADJ_TIMECONST)
+        {
+            long constant = tx->constant + ((status & STA_NANO) ? 0 : 4);
+            time_constant = std::min(std::max(constant, 0L), MAX_TIME_CONSTANT);
+        }
+
+        if (modes & ADJ_OFFSET)
+        {
+            update_offset(tx->offset);
+        }
+
+        tx->offset = (long)(time_offset_ns / ((status & STA_NANO) ? 1 : 1000));
+        tx->freq = (long)(time_freq_ppb * 65536.0 / 1000.0);
+        tx->status = status;
+        tx->constant = time_constant;
+        return TIME_OK;
+    }
+
+private:
+    static constexpr int64_t NSEC_PER_SEC = 1000000000LL;
+    static constexpr int SHIFT_PLL = 2;
+    static constexpr int SHIFT_FLL = 2;
+    static constexpr long MINSEC = 256;
+    static constexpr long MAXSEC = 2048;
+    static constexpr long MAX_TIME_CONSTANT = 10;
+    static constexpr double MAX_PHASE_NS = 500000000.0;
+    static constexpr double MAX_FREQ_PPB = 500000.0;
+
+    int64_t now_ns;
+    int64_t next_second_ns;
+    double offset;
+
+    double oscillator_ppb;
+    double wander_ppb;
+    std::mt19937_64 rng;
+    std::normal_distribution<double> gauss;
+
+    /* Kernel NTP state */
+    int status;
+    long time_constant;
+    double time_offset_ns; /* phase error still to be slewed */
+    double time_freq_ppb;  /* frequency correction */
+    double slew_ppb;       /* slew applied during the current second */
+    int64_t time_reftime;  /* system seconds of the last ADJ_OFFSET */
+
+    uint64_t gettime_calls;
+    uint64_t settime_calls;
+    uint64_t adjtime_calls;
+    uint64_t setoffset_calls;
+
+    int64_t system_seconds() const
+    {
+        return (now_ns + (int64_t)floor(offset)) / NSEC_PER_SEC;
+    }
+
+    static double clamp_frequency(double ppb)
+    {
+        return std::min(std::max(ppb, -MAX_FREQ_PPB), MAX_FREQ_PPB);
+    }
+
+    void integrate(int64_t to_ns)
+    {
+        offset += frequency_ppb() * (double)(to_ns - now_ns) / NSEC_PER_SEC;
+        now_ns = to_ns;
+    }
+
+    /*
+     * Once per second: hand the next chunk of the phase error to the
+     * tick length, and let the oscillator wander
+     */
+    void second_overflow()
+    {
+        double chunk = trunc(time_offset_ns / (double)(1L << (SHIFT_PLL + time_constant)));
+        time_offset_ns -= chunk;
+        slew_ppb = chunk;
+
+        if (wander_ppb > 0.0)
+        {
+            oscillator_ppb += wander_ppb * gauss(rng);
+        }
+    }
+
+    /* ntp_update_offset() */
+    void update_offset(long value)
+    {
+        if (!(status & STA_PLL))
+        {
+            return;
+        }
+
+        double offset_ns = (double)value * ((status & STA_NANO) ? 1 : 1000);
+        offset_ns = std::min(std::max(offset_ns, -MAX_PHASE_NS), MAX_PHASE_NS);
+
+        int64_t now_sec = system_seconds();
+        int64_t secs = now_sec - time_reftime;
+        if (status & STA_FREQHOLD)
+        {
+            secs = 0;
+        }
+        time_reftime = now_sec;
+
+        double freq_adj = 0.0;
+        status &= ~STA_MODE;
+        if (secs >= MINSEC && ((status & STA_FLL) || secs > MAXSEC))
+        {
+            status |= STA_MODE;
+            freq_adj = offset_ns / (double)(1L << SHIFT_FLL) / (double)secs;
+        }
+
+        secs = std::min<int64_t>(secs, 1L << (SHIFT_PLL + 1 + time_constant));
+        freq_adj += offset_ns * (double)secs / (double)(1L << (2 * (SHIFT_PLL + 2 + time_constant)));
+        time_freq_ppb = clamp_frequency(freq_adj + time_freq_ppb);
+
+        time_offset_ns = offset_ns;
+    }
+};
+
+/*
+ * Discrete-event simulator
+ *
+ * Events run in true-time order; the simulated clock is advanced to
+ * each event's time before it fires. Equal-time events run in the
+ * order they were scheduled.
+ */
+class clock_simulator
+{
+public:
+    /* 2026-01-01T00:00:00Z */
+    static constexpr int64_t default_start_ns = 1767225600LL * 1000000000LL;
+
+    explicit clock_simulator(const clock_model& model, int64_t start_ns = default_start_ns)
+        : sim_clock(model, start_ns),
+          next_seq(0)
+    {}
+
+    simulated_clock& clock() { return sim_clock; }
+    int64_t now_ns() const { return sim_clock.true_ns(); }
+
+    void schedule_at(int64_t true_ns, std::function<void()> action)
+    {
+        events.push_back(event{std::max(true_ns, now_ns()), next_seq++, std::move(action)});
+        std::push_heap(events.begin(), events.end(), later());
+    }
+
+    void schedule_after(int64_t delay_ns, std::function<void()> action)
+    {
+        schedule_at(now_ns() + delay_ns, std::move(action));
+    }
+
+    /* Run every event up to and including true_ns, then advance the clock to it */
+    void run_until(int64_t true_ns)
+    {
+        while (!events.empty() && events.front().at <= true_ns)
+        {
+            std::pop_heap(events.begin(), events.end(), later());
+            event next = std::move(events.back());
+            events.pop_back();
+
+            sim_clock.advance_to(next.at);
+            next.action();
+        }
+        sim_clock.advance_to(true_ns);
+    }
+
+    void run_for(int64_t duration_ns)
+    {
+        run_until(now_ns() + duration_ns);
+    }
+
+private:
+    struct event
+    {
+        int64_t at;
+        uint64_t seq;
+        std::function<void()> action;
+    };
+
+    struct later
+    {
+        bool operator()(const event& a, const event& b) const
+        {
+            return a.at != b.at ? a.at > b.at : a.seq > b.seq;
+        }
+    };
+
+    simulated_clock sim_clock;
+    std::vector<event> events;
+    uint64_t next_seq;
+};
+
+#endif // CLOCK_SIMULATOR_H
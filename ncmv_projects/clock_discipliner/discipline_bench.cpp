@@ -0,0 +1,185 @@
+#include "clock_discipliner.h"
+#include "discipline_thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Per-sample cost of the discipline pipeline. Never touches the system
+ * clock.
+ *
+ *   clock_discipline_bench [samples]
+ *
+ * Feeds `samples` (default 10 M) 10 Hz offsets with a few microseconds of
+ * noise through on_time_sample(), so every tenth sample makes a discipline
+ * decision and one clock_adjtime() call on a stub clock:
+ *
+ * - backend_clock_discipliner over a stub clock_backend (virtual calls)
+ * - basic_clock_discipliner with the stub as its Clock policy, as the
+ *   default clock_discipliner has realtime_clock
+ * - both with and without the stability statistics
+ * - the null_clock composition behind a discipline_thread, samples
+ *   submitted from this thread and drained on the timer
+ *
+ * The default composition can't be timed here without adjusting the
+ * system clock, so it is checked at compile time instead: every policy of
+ * clock_discipliner is a concrete class with no virtual functions, and
+ * its Clock reaches CLOCK_REALTIME directly rather than through
+ * clock_backend.
+ */
+
+static_assert(std::is_same<clock_discipliner::clock_type, realtime_clock>::value,
+              "clock_discipliner must call CLOCK_REALTIME directly");
+static_assert(!std::is_polymorphic<clock_discipliner::filter_type>::value &&
+                  !std::is_polymorphic<clock_discipliner::controller_type>::value &&
+                  !std::is_polymorphic<clock_discipliner::actuator_type>::value &&
+                  !std::is_polymorphic<clock_discipliner::clock_type>::value,
+              "clock_discipliner policies must not dispatch virtually");
+static_assert(std::is_empty<realtime_clock>::value, "realtime_clock must not hold a clock_backend");
+
+static const int64_t NSEC_PER_SEC = 1000000000LL;
+
+/* Does nothing, through clock_backend's virtual interface */
+class null_backend : public clock_backend
+{
+public:
+    int gettime(struct timespec* ts) override
+    {
+        ts->tv_sec = 1767225600;
+        ts->tv_nsec = 0;
+        return 0;
+    }
+
+    int settime(const struct timespec*) override { return 0; }
+
+    int adjtime(struct timex* tx) override
+    {
+        tx->freq = 0;
+        tx->status = STA_PLL;
+        return TIME_OK;
+    }
+};
+
+/* The same as a Clock policy: no virtual calls */
+class null_clock
+{
+public:
+    int gettime(struct timespec* ts)
+    {
+        ts->tv_sec = 1767225600;
+        ts->tv_nsec = 0;
+        return 0;
+    }
+
+    int adjtime(struct timex* tx)
+    {
+        tx->freq = 0;
+        tx->status = STA_PLL;
+        return TIME_OK;
+    }
+};
+
+static std::vector<int64_t> make_offsets(size_t count)
+{
+    std::vector<int64_t> offsets(count);
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < count; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        offsets[i] = (int64_t)(state % 10000) - 5000; /* +/-5 us */
+    }
+    return offsets;
+}
+
+template <class Discipliner>
+static double run(Discipliner& discipliner, const std::vector<int64_t>& offsets)
+{
+    discipliner.set_log(nullptr);
+    const uint64_t start_ns = 1767225600ULL * NSEC_PER_SEC;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < offsets.size(); ++i)
+    {
+        uint64_t receive_ns = start_ns + i * (NSEC_PER_SEC / 10);
+        discipliner.on_time_sample(receive_ns + (uint64_t)offsets[i], receive_ns);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / offsets.size() * 1e9;
+}
+
+static void bench(const char* title, discipline_config config, const std::vector<int64_t>& offsets)
+{
+    printf("%s:\n", title);
+    for (int with_stats = 1; with_stats >= 0; --with_stats)
+    {
+        config.stability.octaves = with_stats ? 12 : 0;
+
+        null_backend backend;
+        backend_clock_discipliner virtual_clock(backend, config);
+        double virtual_ns = run(virtual_clock, offsets);
+
+        basic_clock_discipliner<ewma_filter, threshold_controller, kernel_actuator, null_clock> static_clock(null_clock(), config);
+        double static_ns = run(static_clock, offsets);
+
+        printf("  %-18s backend_clock %6.1f ns/sample | null_clock policy %6.1f ns/sample\n",
+               with_stats ? "stability on" : "stability off", virtual_ns, static_ns);
+    }
+}
+
+static void bench_thread(const std::vector<int64_t>& offsets)
+{
+    typedef basic_clock_discipliner<ewma_filter, threshold_controller, kernel_actuator, null_clock> null_discipliner;
+    null_discipliner discipliner;
+    discipliner.set_log(nullptr);
+    discipline_thread<null_discipliner> worker(discipliner, 1000000LL); /* 1 ms wakes */
+    if (!worker.start())
+    {
+        perror("discipline thread");
+        return;
+    }
+
+    const uint64_t start_ns = 1767225600ULL * NSEC_PER_SEC;
+    uint64_t retries = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < offsets.size(); ++i)
+    {
+        uint64_t receive_ns = start_ns + i * (NSEC_PER_SEC / 10);
+        while (!worker.submit(receive_ns + (uint64_t)offsets[i], receive_ns))
+        {
+            retries++;
+            std::this_thread::yield();
+        }
+    }
+    worker.stop();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("discipline_thread<null_clock policy>: %llu of %zu samples processed, %.1f ns/sample, %llu full-ring retries\n",
+           (unsigned long long)worker.processed(), offsets.size(), elapsed / offsets.size() * 1e9,
+           (unsigned long long)retries);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t samples = argc > 1 ? (size_t)atol(argv[1]) : 10000000;
+    std::vector<int64_t> offsets = make_offsets(samples);
+    printf("%zu samples at 10 Hz, one decision per second\n", samples);
+
+    discipline_config config;
+    bench("EWMA_SLEW, no pre-filter (defaults)", config, offsets);
+
+    config.mode = discipline_mode::PI_LOOP;
+    config.prefilter.mode = prefilter_mode::MIN_DELAY;
+    bench("PI_LOOP, min-delay", config, offsets);
+
+    config.prefilter.mode = prefilter_mode::HAMPEL;
+    bench("PI_LOOP, Hampel", config, offsets);
+
+    bench_thread(offsets);
+    return 0;
+}
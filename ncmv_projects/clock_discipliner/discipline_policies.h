@@ -0,0 +1,453 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef DISCIPLINE_POLICIES_H
+#define DISCIPLINE_POLICIES_H
+
+#pragma once
+
+#include "clock_backend.h"
+#include "clock_controller.h"
+#include "sample_filter.h"
+#include "stability_stats.h"
+
+#include <time.h>
+#include <sys/timex.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/*
+ * Configuration and the four stages of basic_clock_discipliner
+ *
+ * Each stage is a policy class chosen at compile time, so the per-sample
+ * path makes no virtual calls of its own:
+ *
+ * - Filter:     offsets in, one filtered offset out
+ *               (ewma_filter: sample_prefilter, then an EWMA)
+ * - Controller: filtered offset in, discipline_action out
+ *               (threshold_controller: step above the threshold,
+ *               otherwise slew or run the PI loop)
+ * - Actuator:   turns actions into clock_adjtime() calls on the Clock
+ *               (kernel_actuator: ADJ_SETOFFSET, ADJ_OFFSET, ...)
+ * - Clock:      gettime() and adjtime() with clock_backend's conventions
+ *               (realtime_clock: CLOCK_REALTIME called directly;
+ *               backend_clock: any clock_backend, e.g. the simulator)
+ *
+ * A policy only needs the members basic_clock_discipliner calls, listed
+ * with each default below.
+ */
+
+enum class discipline_mode
+{
+    EWMA_SLEW, /* ADJ_OFFSET of the full filtered offset every second */
+    PI_LOOP    /* pi_controller: ADJ_FREQUENCY plus small ADJ_OFFSET corrections */
+};
+
+/*
+ * Predicted holdover error after t seconds without samples:
+ *   |offset at loss| + frequency_uncertainty * t + wander * t^1.5 / sqrt(3)
+ * the last term being the 1-sigma phase of a random-walk frequency.
+ */
+struct holdover_config
+{
+    double timeout_s = 5.0;                   /* no sample for this long: holdover; <= 0 disables */
+    double frequency_uncertainty_ppb = 100.0; /* error of the held frequency */
+    double wander_ppb = 1.0;                  /* random-walk frequency step per second */
+    double reacquire_s = 60.0;                /* then the normal step rule applies again */
+};
+
+/*
+ * Adaptive discipline interval, after NTP's poll exponent: every
+ * decision, a filtered offset within gate x clock jitter (and, for
+ * PI_LOOP, a locked controller) adds exponent + 1 to a counter, anything
+ * else takes twice that away. Past +limit the interval doubles, past
+ * -limit it halves. Clock jitter is the RMS change of the filtered
+ * offset between decisions, floored at min_jitter_ns.
+ *
+ * An offset past the step threshold is acted on at once, and a step or
+ * holdover drops back to min_exponent. PI_LOOP never polls slower than
+ * its frequency time constant: its integral gain grows with the interval
+ * and the loop rings, then steps, past that.
+ */
+struct poll_config
+{
+    bool adaptive = false; /* false: every second */
+    int min_exponent = 0;  /* 1 s */
+    int max_exponent = 6;  /* 64 s */
+    double gate = 4.0;
+    int limit = 30;
+    double min_jitter_ns = 10000.0;
+};
+
+struct discipline_config
+{
+    discipline_mode mode = discipline_mode::EWMA_SLEW;
+    double ewma_alpha = 0.2;
+    int64_t step_threshold_ns = 3LL * 1000000LL; /* step instead of slewing above 3 ms */
+    prefilter_config prefilter;
+    pi_config pi;
+    stability_config stability; /* off unless octaves > 0; sample_interval_s should match the source rate */
+    holdover_config holdover;
+    poll_config poll;
+};
+
+/*
+ * Clock: any clock_backend, one virtual call per access, so the
+ * simulator, replay and sweep can hand in simulated_clock
+ * (backend_clock_discipliner)
+ */
+class backend_clock
+{
+public:
+    backend_clock(clock_backend& clock = default_clock_backend())
+        : backend(&clock)
+    {}
+
+    int gettime(struct timespec* ts) { return backend->gettime(ts); }
+    int adjtime(struct timex* tx) { return backend->adjtime(tx); }
+
+private:
+    clock_backend* backend;
+};
+
+/*
+ * Clock: CLOCK_REALTIME, called directly. The default.
+ */
+class realtime_clock
+{
+public:
+    int gettime(struct timespec* ts) { return clock_gettime(CLOCK_REALTIME, ts); }
+    int adjtime(struct timex* tx) { return clock_adjtime(CLOCK_REALTIME, tx); }
+};
+
+/*
+ * Filter: optional sample_prefilter, then an exponentially weighted
+ * moving average seeded with the first sample
+ */
+class ewma_filter
+{
+public:
+    explicit ewma_filter(const discipline_config& config)
+        : prefilter(config.prefilter),
+          alpha(config.ewma_alpha),
+          estimate_ns(0),
+          count(0)
+    {}
+
+    /* Returns the pre-filtered offset */
+    int64_t add(int64_t offset_ns)
+    {
+        int64_t filtered_ns = prefilter.filter(offset_ns);
+        if (count == 0)
+        {
+            estimate_ns = filtered_ns;
+        }
+        else
+        {
+            estimate_ns = (int64_t)((1.0 - alpha) * estimate_ns + alpha * filtered_ns);
+        }
+        count++;
+        return filtered_ns;
+    }
+
+    int64_t offset() const { return estimate_ns; }
+
+    /* No sample since construction or restart() */
+    bool empty() const { return count == 0; }
+
+    /* The clock moved by -delta: keep history, shifted */
+    void shift(int64_t delta)
+    {
+        estimate_ns += delta;
+        prefilter.shift(delta);
+    }
+
+    /* Forget history; the next sample seeds the average */
+    void restart()
+    {
+        prefilter.reset();
+        count = 0;
+    }
+
+private:
+    sample_prefilter prefilter;
+    const double alpha;
+    int64_t estimate_ns;
+    int64_t count;
+};
+
+enum class discipline_action_kind
+{
+    NONE,  /* leave the clock alone */
+    STEP,  /* offset_ns */
+    SLEW,  /* offset_ns through the kernel PLL */
+    STEER  /* frequency_ppb, phase_ns and time_constant, kernel PLL held */
+};
+
+struct discipline_action
+{
+    discipline_action_kind kind;
+    int64_t offset_ns;
+    double frequency_ppb;
+    double phase_ns;
+    long time_constant;
+};
+
+/*
+ * Controller: step past step_threshold_ns when allowed, otherwise slew
+ * the filtered offset (EWMA_SLEW) or run pi_controller (PI_LOOP)
+ */
+class threshold_controller
+{
+public:
+    explicit threshold_controller(const discipline_config& config)
+        : mode(config.mode),
+          threshold_ns(config.step_threshold_ns),
+          pi(config.pi),
+          poll_limit(config.poll.max_exponent)
+    {
+        if (mode == discipline_mode::PI_LOOP)
+        {
+            int limit = (int)floor(log2(fmax(config.pi.frequency_time_constant_s, 1.0)));
+            poll_limit = limit < poll_limit ? limit : poll_limit;
+        }
+    }
+
+    int64_t step_threshold_ns() const { return threshold_ns; }
+
+    discipline_action decide(int64_t offset_ns, double interval_s, bool may_step)
+    {
+        int64_t abs_offset_ns = offset_ns >= 0 ? offset_ns : -offset_ns;
+        if (abs_offset_ns > threshold_ns && may_step)
+        {
+            return discipline_action{discipline_action_kind::STEP, offset_ns, 0.0, 0.0, 0};
+        }
+
+        if (mode != discipline_mode::PI_LOOP)
+        {
+            return discipline_action{discipline_action_kind::SLEW, offset_ns, 0.0, 0.0, 0};
+        }
+
+        pi_controller::correction c = pi.update((double)offset_ns, interval_s);
+        if (!c.active)
+        {
+            return discipline_action{discipline_action_kind::NONE, 0, 0.0, 0.0, 0};
+        }
+        return discipline_action{discipline_action_kind::STEER, 0, c.frequency_ppb, c.phase_ns, pi.kernel_time_constant()};
+    }
+
+    void on_step() { pi.on_step(); }
+
+    /* Sets the kernel frequency itself; otherwise the kernel PLL learns it */
+    bool steers_frequency() const { return mode == discipline_mode::PI_LOOP; }
+
+    /* Kernel in ADJ_NANO: steps are exact, not rounded to a microsecond */
+    bool nanosecond_units() const { return mode == discipline_mode::PI_LOOP; }
+
+    double frequency_ppb() const { return pi.frequency_ppb(); }
+
+    /* Settled enough for the poll interval to grow */
+    bool is_locked() const { return mode != discipline_mode::PI_LOOP || pi.is_locked(); }
+
+    int max_poll_exponent() const { return poll_limit; }
+
+private:
+    const discipline_mode mode;
+    const int64_t threshold_ns;
+    pi_controller pi;
+    int poll_limit;
+};
+
+/*
+ * Actuator: the kernel NTP interface. Every call returns what
+ * clock_adjtime() returned, with errno intact; frequency_ppb receives the
+ * kernel frequency on success.
+ *
+ * Of the kernel status word only STA_PLL and STA_FREQHOLD are ours. The
+ * word is written only when they need changing, read first so the other
+ * bits (leap second STA_INS/STA_DEL, PPS, ...) go back as they were.
+ */
+class kernel_actuator
+{
+public:
+    kernel_actuator()
+        : status_held(false)
+    {}
+
+    /*
+     * ADJ_SETOFFSET steps inside the kernel, so nothing runs between
+     * reading the clock and setting it; the same call cancels any
+     * pending ADJ_OFFSET, which was aimed at the old offset. step_ns must
+     * be whole microseconds unless nano.
+     */
+    template <class Clock>
+    int step(Clock& clock, int64_t step_ns, bool nano)
+    {
+        int64_t sec = step_ns / 1000000000LL;
+        int64_t sub_ns = step_ns % 1000000000LL;
+        if (sub_ns < 0)
+        {
+            sec--;
+            sub_ns += 1000000000LL;
+        }
+
+        struct timex tx;
+        memset(&tx, 0, sizeof(tx));
+        tx.modes = ADJ_SETOFFSET | ADJ_OFFSET | (nano ? ADJ_NANO : 0);
+        tx.time.tv_sec = sec;
+        tx.time.tv_usec = nano ? sub_ns : sub_ns / 1000; /* ns with ADJ_NANO */
+        tx.offset = 0;
+        return clock.adjtime(&tx);
+    }
+
+    /* ADJ_OFFSET in microseconds; the kernel slews it gradually */
+    template <class Clock>
+    int slew(Clock& clock, int64_t offset_ns, double& frequency_ppb)
+    {
+        struct timex tx;
+        memset(&tx, 0, sizeof(tx));
+        tx.modes = ADJ_OFFSET;
+        tx.offset = offset_ns / 1000;
+        return finish(clock.adjtime(&tx), tx, frequency_ppb);
+    }
+
+    /*
+     * Learned frequency via ADJ_FREQUENCY, the remaining offset via
+     * ADJ_OFFSET. STA_FREQHOLD keeps the kernel's own PLL from
+     * integrating the offset a second time. Once the previous call saw
+     * STA_PLL | STA_FREQHOLD set, the status is not written at all.
+     */
+    template <class Clock>
+    int steer(Clock& clock, const discipline_action& action, double& frequency_ppb)
+    {
+        struct timex tx;
+        memset(&tx, 0, sizeof(tx));
+        if (!status_held)
+        {
+            int status;
+            int ret = read_status(clock, status);
+            if (ret < 0)
+            {
+                return ret;
+            }
+            tx.modes = ADJ_STATUS;
+            tx.status = status | owned_status;
+        }
+        tx.modes |= ADJ_NANO | ADJ_FREQUENCY | ADJ_TIMECONST | ADJ_OFFSET;
+        tx.freq = (long)(action.frequency_ppb * 65.536); /* ppm with 16-bit fraction */
+        tx.constant = action.time_constant;
+        tx.offset = (long)action.phase_ns;
+        return finish(clock.adjtime(&tx), tx, frequency_ppb);
+    }
+
+    /*
+     * Holdover: no phase corrections, frequency held. ADJ_OFFSET 0
+     * cancels the pending phase correction; set_frequency also installs
+     * held_ppb. saved_status receives the kernel status to restore(),
+     * status_saved whether reading it succeeded; if not, there is
+     * nothing to restore and the status is left alone.
+     */
+    template <class Clock>
+    int hold(Clock& clock, bool set_frequency, double held_ppb, bool& status_saved, int& saved_status,
+             double& frequency_ppb)
+    {
+        status_saved = read_status(clock, saved_status) >= 0;
+
+        struct timex tx;
+        memset(&tx, 0, sizeof(tx));
+        tx.modes = ADJ_OFFSET;
+        if (status_saved)
+        {
+            tx.modes |= ADJ_STATUS;
+            tx.status = saved_status | owned_status;
+        }
+        tx.offset = 0;
+        if (set_frequency)
+        {
+            tx.modes |= ADJ_FREQUENCY;
+            tx.freq = (long)(held_ppb * 65.536);
+        }
+        return finish(clock.adjtime(&tx), tx, frequency_ppb);
+    }
+
+    /*
+     * After holdover: STA_PLL and STA_FREQHOLD as hold() found them in
+     * saved_status, every other bit as it is now
+     */
+    template <class Clock>
+    int restore(Clock& clock, int saved_status)
+    {
+        int status;
+        int ret = read_status(clock, status);
+        if (ret < 0)
+        {
+            return ret;
+        }
+
+        struct timex tx;
+        memset(&tx, 0, sizeof(tx));
+        tx.modes = ADJ_STATUS;
+        tx.status = (status & ~owned_status) | (saved_status & owned_status);
+        ret = clock.adjtime(&tx);
+        note_status(ret, tx);
+        return ret;
+    }
+
+private:
+    static const int owned_status = STA_PLL | STA_FREQHOLD;
+
+    bool status_held; /* STA_PLL | STA_FREQHOLD were set after the last call */
+
+    void note_status(int ret, const struct timex& tx)
+    {
+        if (ret >= 0)
+        {
+            status_held = (tx.status & owned_status) == owned_status;
+        }
+    }
+
+    /* modes 0 only reads */
+    template <class Clock>
+    static int read_status(Clock& clock, int& status)
+    {
+        struct timex tx;
+        memset(&tx, 0, sizeof(tx));
+        int ret = clock.adjtime(&tx);
+        status = ret < 0 ? 0 : tx.status;
+        return ret;
+    }
+
+    int finish(int ret, const struct timex& tx, double& frequency_ppb)
+    {
+        if (ret >= 0)
+        {
+            frequency_ppb = tx.freq / 65.536; /* ppm with 16-bit fraction */
+        }
+        note_status(ret, tx);
+        return ret;
+    }
+};
+
+#endif // DISCIPLINE_POLICIES_H
@@ -0,0 +1,203 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef DISCIPLINE_THREAD_H
+#define DISCIPLINE_THREAD_H
+
+#pragma once
+
+#include "clock_discipliner.h"
+#include "spsc_ring.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include <atomic>
+#include <thread>
+
+/*
+ * Runs a discipliner on its own thread: clock_discipliner by default, or
+ * any basic_clock_discipliner composition
+ *
+ * The receiver thread only calls submit(), which copies the sample into
+ * a wait-free SPSC ring: no locks, no syscalls, no printing. A timerfd
+ * wakes the discipline thread at the discipline rate (1 Hz by default);
+ * it drains the ring in batches and feeds every sample to
+ * on_time_sample(), where filtering and clock adjustment happen, then
+ * lets the discipliner check for source loss.
+ *
+ * The discipliner must only be used through this object while running.
+ */
+
+struct time_sample
+{
+    uint64_t source_ns;
+    uint64_t receive_ns;
+};
+
+template <class Discipliner = clock_discipliner>
+class discipline_thread
+{
+public:
+    explicit discipline_thread(Discipliner& target, int64_t wake_interval_ns = 1000000000LL)
+        : discipliner(target),
+          interval_ns(wake_interval_ns),
+          timer_fd(-1),
+          running(false),
+          dropped_count(0),
+          processed_count(0)
+    {}
+
+    ~discipline_thread()
+    {
+        stop();
+    }
+
+    discipline_thread(const discipline_thread&) = delete;
+    discipline_thread& operator=(const discipline_thread&) = delete;
+
+    /* Returns false if the timer cannot be created */
+    bool start()
+    {
+        if (worker.joinable())
+        {
+            return true;
+        }
+
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (timer_fd < 0)
+        {
+            return false;
+        }
+
+        struct itimerspec spec;
+        spec.it_interval.tv_sec = interval_ns / 1000000000LL;
+        spec.it_interval.tv_nsec = interval_ns % 1000000000LL;
+        spec.it_value = spec.it_interval;
+        if (timerfd_settime(timer_fd, 0, &spec, nullptr) < 0)
+        {
+            close(timer_fd);
+            timer_fd = -1;
+            return false;
+        }
+
+        running.store(true, std::memory_order_release);
+        worker = std::thread([this]() { run(); });
+        return true;
+    }
+
+    /* Wakes the thread, lets it drain what is queued, and joins it */
+    void stop()
+    {
+        if (!worker.joinable())
+        {
+            return;
+        }
+
+        running.store(false, std::memory_order_release);
+
+        struct itimerspec now;
+        now.it_interval.tv_sec = 0;
+        now.it_interval.tv_nsec = 0;
+        now.it_value.tv_sec = 0;
+        now.it_value.tv_nsec = 1;
+        timerfd_settime(timer_fd, 0, &now, nullptr);
+
+        worker.join();
+        close(timer_fd);
+        timer_fd = -1;
+    }
+
+    /*
+     * Receiver thread only. Wait-free; returns false (and counts a drop)
+     * if the discipline thread has fallen a full ring behind.
+     */
+    bool submit(uint64_t source_ns, uint64_t receive_ns)
+    {
+        if (!ring.try_push(time_sample{source_ns, receive_ns}))
+        {
+            dropped_count.store(dropped_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    bool submit(uint64_t source_ns, const struct timespec& received)
+    {
+        return submit(source_ns, (uint64_t)received.tv_sec * 1000000000ULL + (uint64_t)received.tv_nsec);
+    }
+
+    uint64_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+    uint64_t processed() const { return processed_count.load(std::memory_order_relaxed); }
+
+private:
+    static const size_t batch_size = 64;
+
+    Discipliner& discipliner;
+    const int64_t interval_ns;
+    int timer_fd;
+    std::thread worker;
+    std::atomic<bool> running;
+
+    spsc_ring<time_sample, 1024> ring;
+    std::atomic<uint64_t> dropped_count;   /* written by the receiver only */
+    std::atomic<uint64_t> processed_count; /* written by the discipline thread only */
+
+    void run()
+    {
+        while (running.load(std::memory_order_acquire))
+        {
+            uint64_t expirations;
+            if (read(timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EINTR)
+            {
+                break;
+            }
+            drain();
+            discipliner.check_source();
+        }
+        drain();
+    }
+
+    /*
+     * Samples still queued when one of them triggers a step were
+     * received before it; the discipliner drops them by receive time
+     */
+    void drain()
+    {
+        time_sample batch[batch_size];
+        size_t count;
+        while ((count = ring.pop_batch(batch, batch_size)) > 0)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                discipliner.on_time_sample(batch[i].source_ns, batch[i].receive_ns);
+            }
+            processed_count.store(processed_count.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+        }
+    }
+};
+
+#endif // DISCIPLINE_THREAD_H
@@ -0,0 +1,137 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#pragma once
+
+#include "clock_discipliner.h"
+#include "clock_simulator.h"
+#include "sample_capture.h"
+
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+/*
+ * Replays a capture against a simulated clock at full CPU speed
+ *
+ * The capture supplies the source times and each sample's delivery
+ * delay (receive minus source); the simulated clock supplies the local
+ * oscillator. Sample i is emitted at true time source_i and handed to
+ * the discipliner, stamped with the simulated clock, delay_i later.
+ * The capturing host's own clock error is folded into the delays, so
+ * captures should come from a host whose clock was already disciplined.
+ * If any delay is negative, all delays are shifted up so the smallest
+ * is zero.
+ *
+ * The true offset is sampled once per second; the first warmup_s seconds
+ * are left out of the score.
+ */
+
+struct replay_result
+{
+    double mean_ns;
+    double rms_ns;
+    double max_abs_ns;
+    uint64_t steps;
+    uint64_t adjtime_calls;
+    uint64_t samples;
+};
+
+inline replay_result replay_capture(const std::vector<capture_record>& capture, const clock_model& model,
+                                    const discipline_config& config, double warmup_s = 300.0)
+{
+    replay_result result = {};
+    if (capture.empty())
+    {
+        return result;
+    }
+
+    const int64_t NSEC_PER_SEC = 1000000000LL;
+    const int64_t start_ns = (int64_t)capture.front().source_ns;
+
+    int64_t lowest_delay_ns = 0;
+    for (const capture_record& r : capture)
+    {
+        lowest_delay_ns = std::min(lowest_delay_ns, (int64_t)(r.receive_ns - r.source_ns));
+    }
+
+    clock_simulator sim(model, start_ns);
+    backend_clock_discipliner discipliner(sim.clock(), config);
+    discipliner.set_log(nullptr);
+
+    size_t next = 0;
+    std::function<void()> emit = [&]()
+    {
+        const capture_record& r = capture[next++];
+        int64_t delay_ns = (int64_t)(r.receive_ns - r.source_ns) - lowest_delay_ns;
+        uint64_t source_ns = r.source_ns;
+        sim.schedule_after(delay_ns, [&discipliner, &sim, source_ns]()
+        {
+            struct timespec received;
+            sim.clock().gettime(&received);
+            discipliner.on_time_sample(source_ns, received);
+        });
+
+        if (next < capture.size())
+        {
+            sim.schedule_at((int64_t)capture[next].source_ns, emit);
+        }
+    };
+    sim.schedule_at(start_ns, emit);
+
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    uint64_t count = 0;
+    const int64_t scored_from_ns = start_ns + (int64_t)(warmup_s * NSEC_PER_SEC);
+    std::function<void()> probe = [&]()
+    {
+        if (sim.now_ns() >= scored_from_ns)
+        {
+            double offset = sim.clock().offset_ns();
+            sum += offset;
+            sum_squares += offset * offset;
+            result.max_abs_ns = std::max(result.max_abs_ns, fabs(offset));
+            count++;
+        }
+        sim.schedule_after(NSEC_PER_SEC, probe);
+    };
+    sim.schedule_after(NSEC_PER_SEC, probe);
+
+    sim.run_until((int64_t)capture.back().receive_ns - lowest_delay_ns + NSEC_PER_SEC);
+
+    result.mean_ns = count ? sum / count : 0.0;
+    result.rms_ns = count ? sqrt(sum_squares / count) : 0.0;
+    result.steps = sim.clock().step_count();
+    result.adjtime_calls = sim.clock().adjtime_count();
+    result.samples = capture.size();
+    return result;
+}
+
+#endif // REPLAY_H
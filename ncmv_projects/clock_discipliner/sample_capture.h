@@ -0,0 +1,149 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SAMPLE_CAPTURE_H
+#define SAMPLE_CAPTURE_H
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+/*
+ * Capture file of raw (source time, receive time) samples, for replay
+ *
+ * File layout: capture_file_header, then capture_record after
+ * capture_record, native byte order. Writes go through stdio buffering,
+ * so append() costs a memcpy; call it from the thread that reads the
+ * source, not from a signal handler.
+ */
+
+struct capture_record
+{
+    uint64_t source_ns;  /* source time, nanoseconds since epoch */
+    uint64_t receive_ns; /* local clock at reception */
+};
+
+static_assert(sizeof(capture_record) == 16, "capture_record is a file format");
+
+struct capture_file_header
+{
+    char magic[8];        /* "CDCAPT01" */
+    uint32_t record_size; /* sizeof(capture_record) */
+    uint32_t reserved;
+};
+
+class capture_writer
+{
+public:
+    capture_writer()
+        : file(nullptr)
+    {}
+
+    ~capture_writer()
+    {
+        close();
+    }
+
+    capture_writer(const capture_writer&) = delete;
+    capture_writer& operator=(const capture_writer&) = delete;
+
+    bool open(const char* path)
+    {
+        close();
+        file = fopen(path, "wb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        capture_file_header header;
+        memcpy(header.magic, "CDCAPT01", sizeof(header.magic));
+        header.record_size = sizeof(capture_record);
+        header.reserved = 0;
+        if (fwrite(&header, sizeof(header), 1, file) != 1)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool is_open() const { return file != nullptr; }
+
+    void append(uint64_t source_ns, uint64_t receive_ns)
+    {
+        if (file != nullptr)
+        {
+            capture_record r = {source_ns, receive_ns};
+            fwrite(&r, sizeof(r), 1, file);
+        }
+    }
+
+    void close()
+    {
+        if (file != nullptr)
+        {
+            fclose(file);
+            file = nullptr;
+        }
+    }
+
+private:
+    FILE* file;
+};
+
+/* Reads a whole capture; false if it cannot be opened or is not a capture */
+inline bool load_capture(const char* path, std::vector<capture_record>& samples)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    capture_file_header header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, "CDCAPT01", sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(capture_record))
+    {
+        fclose(file);
+        return false;
+    }
+
+    samples.clear();
+    capture_record batch[4096];
+    size_t count;
+    while ((count = fread(batch, sizeof(capture_record), 4096, file)) > 0)
+    {
+        samples.insert(samples.end(), batch, batch + count);
+    }
+
+    fclose(file);
+    return true;
+}
+
+#endif // SAMPLE_CAPTURE_H
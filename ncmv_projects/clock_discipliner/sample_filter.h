@@ -0,0 +1,282 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SAMPLE_FILTER_H
+#define SAMPLE_FILTER_H
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include <vector>
+
+/*
+ * Offset pre-filters, run on every sample ahead of the EWMA
+ *
+ * - MEDIAN:    median of the last `window` offsets
+ * - HAMPEL:    passes a sample through unless it is more than hampel_k
+ *              robust standard deviations from the window median, in
+ *              which case the median replaces it
+ * - MIN_DELAY: "lucky packet" selection. Delivery delay only ever makes
+ *              the source look older, so the largest offset in the
+ *              window is the sample that travelled fastest
+ *
+ * The median and the median absolute deviation come from a sorted copy
+ * of the window: a rank is an index, a count two binary searches, and
+ * keeping it sorted costs a memmove of at most `window` values per
+ * sample. MIN_DELAY keeps a monotonic deque, O(1) amortized.
+ */
+
+enum class prefilter_mode
+{
+    NONE,
+    MEDIAN,
+    HAMPEL,
+    MIN_DELAY
+};
+
+struct prefilter_config
+{
+    prefilter_mode mode = prefilter_mode::NONE;
+    size_t window = 10;    /* samples: one second of a 10 Hz source */
+    double hampel_k = 3.0; /* outlier threshold, in robust standard deviations */
+};
+
+/*
+ * The last `window` values, in arrival order and sorted
+ */
+class sliding_order_statistics
+{
+public:
+    explicit sliding_order_statistics(size_t window)
+        : capacity(window > 0 ? window : 1)
+    {
+        ranked.reserve(capacity);
+    }
+
+    void push(int64_t value)
+    {
+        if (fifo.size() == capacity)
+        {
+            /* Any copy of an equal value will do */
+            ranked.erase(std::lower_bound(ranked.begin(), ranked.end(), fifo.front()));
+            fifo.pop_front();
+        }
+
+        ranked.insert(std::upper_bound(ranked.begin(), ranked.end(), value), value);
+        fifo.push_back(value);
+    }
+
+    size_t size() const { return fifo.size(); }
+
+    /* Value of the given rank, 0 = smallest */
+    int64_t at(size_t rank) const
+    {
+        return ranked[rank];
+    }
+
+    int64_t median() const
+    {
+        size_t n = size();
+        int64_t low = at((n - 1) / 2);
+        int64_t high = at(n / 2);
+
+        /* Halve first: offsets may be saturated to +/-INT64_MAX */
+        return low / 2 + high / 2 + (low % 2 + high % 2) / 2;
+    }
+
+    /* Number of values in [low, high] */
+    size_t count_between(int64_t low, int64_t high) const
+    {
+        return std::upper_bound(ranked.begin(), ranked.end(), high) - std::lower_bound(ranked.begin(), ranked.end(), low);
+    }
+
+    /*
+     * Median absolute deviation from `center`: the smallest d with at
+     * least half the values within center +/- d. Binary search over d
+     * up to the window's spread, each probe O(log n).
+     */
+    uint64_t median_absolute_deviation(int64_t center) const
+    {
+        size_t needed = (size() + 1) / 2;
+        uint64_t low = 0;
+        uint64_t high = std::max(distance(center, at(0)), distance(center, at(size() - 1)));
+        while (low < high)
+        {
+            uint64_t d = low + (high - low) / 2;
+            if (count_between(saturating_add(center, -(int64_t)std::min<uint64_t>(d, INT64_MAX)),
+                              saturating_add(center, (int64_t)std::min<uint64_t>(d, INT64_MAX))) >= needed)
+            {
+                high = d;
+            }
+            else
+            {
+                low = d + 1;
+            }
+        }
+        return low;
+    }
+
+    void clear()
+    {
+        ranked.clear();
+        fifo.clear();
+    }
+
+    /*
+     * Add delta to every value. Saturating addition never reorders, so
+     * both copies stay as they are
+     */
+    void shift(int64_t delta)
+    {
+        for (int64_t& value : ranked)
+        {
+            value = saturating_add(value, delta);
+        }
+        for (int64_t& value : fifo)
+        {
+            value = saturating_add(value, delta);
+        }
+    }
+
+    static int64_t saturating_add(int64_t a, int64_t b)
+    {
+        if (b > 0 && a > INT64_MAX - b)
+        {
+            return INT64_MAX;
+        }
+        if (b < 0 && a < INT64_MIN - b)
+        {
+            return INT64_MIN;
+        }
+        return a + b;
+    }
+
+private:
+    static uint64_t distance(int64_t a, int64_t b)
+    {
+        return a >= b ? (uint64_t)a - (uint64_t)b : (uint64_t)b - (uint64_t)a;
+    }
+
+    size_t capacity;
+    std::vector<int64_t> ranked; /* sorted */
+    std::deque<int64_t> fifo;    /* arrival order */
+};
+
+class sample_prefilter
+{
+public:
+    explicit sample_prefilter(const prefilter_config& config = prefilter_config())
+        : cfg(config),
+          window(config.window),
+          seen(0),
+          replaced(0)
+    {
+        if (cfg.window == 0)
+        {
+            cfg.window = 1;
+        }
+    }
+
+    int64_t filter(int64_t offset_ns)
+    {
+        switch (cfg.mode)
+        {
+            case prefilter_mode::MEDIAN:
+                window.push(offset_ns);
+                return window.median();
+
+            case prefilter_mode::HAMPEL:
+            {
+                window.push(offset_ns);
+                int64_t median = window.median();
+
+                /* 1.4826 * MAD estimates sigma for normal data and tolerates up to 50% outliers */
+                double sigma = 1.4826 * (double)window.median_absolute_deviation(median);
+                if (fabs((double)(offset_ns - median)) > cfg.hampel_k * sigma)
+                {
+                    replaced++;
+                    return median;
+                }
+                return offset_ns;
+            }
+
+            case prefilter_mode::MIN_DELAY:
+            {
+                while (!largest.empty() && largest.back().first <= offset_ns)
+                {
+                    largest.pop_back();
+                }
+                largest.push_back(std::make_pair(offset_ns, seen));
+                if (largest.front().second + cfg.window <= seen)
+                {
+                    largest.pop_front();
+                }
+                seen++;
+                return largest.front().first;
+            }
+
+            case prefilter_mode::NONE:
+            default:
+                return offset_ns;
+        }
+    }
+
+    /* Forget history */
+    void reset()
+    {
+        window.clear();
+        largest.clear();
+    }
+
+    /*
+     * Keep history across a clock step: offsets measured before it are
+     * off by exactly the step, so shift them by delta = -step
+     */
+    void shift(int64_t delta)
+    {
+        window.shift(delta);
+        for (std::pair<int64_t, uint64_t>& candidate : largest)
+        {
+            candidate.first = sliding_order_statistics::saturating_add(candidate.first, delta);
+        }
+    }
+
+    /* Samples the Hampel filter replaced with the median */
+    uint64_t outliers() const { return replaced; }
+
+private:
+    prefilter_config cfg;
+    sliding_order_statistics window;
+    std::deque<std::pair<int64_t, uint64_t>> largest; /* MIN_DELAY candidates, decreasing */
+    uint64_t seen;
+    uint64_t replaced;
+};
+
+#endif // SAMPLE_FILTER_H
@@ -0,0 +1,298 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SHARED_STATE_H
+#define SHARED_STATE_H
+
+#pragma once
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <atomic>
+
+/*
+ * Discipline state published through shared memory, vDSO style
+ *
+ * One writer (the discipliner's thread) and any number of reader
+ * processes share a page guarded by a sequence counter: the writer makes
+ * it odd, updates the fields, then makes it even again; a reader retries
+ * until it sees the same even value before and after copying. Readers
+ * never write to the page and never make a syscall after open().
+ *
+ * Every field is a lock-free std::atomic, which is address-free and so
+ * valid across processes; relaxed accesses between the fences keep the
+ * torn reads a seqlock discards free of data races.
+ *
+ * This header has no dependency on clock_discipliner.h, so readers only
+ * need to include it.
+ */
+
+/* One consistent copy of the published state */
+struct disciplined_state
+{
+    uint64_t update_ns;       /* CLOCK_REALTIME when published */
+    int64_t offset_ns;        /* filtered offset, source minus local */
+    double frequency_ppb;     /* frequency correction in effect */
+    double error_bound_ns;    /* predicted error in holdover, else 0 */
+    uint32_t state;           /* discipline_state: 0 tracking, 1 holdover, 2 reacquiring */
+    uint64_t samples;         /* samples seen */
+    uint64_t steps;           /* clock steps applied */
+};
+
+struct shared_state_page
+{
+    static constexpr uint32_t MAGIC = 0x43445354; /* "CDST" */
+    static constexpr uint32_t VERSION = 1;
+
+    std::atomic<uint32_t> magic;
+    std::atomic<uint32_t> version;
+    std::atomic<uint32_t> sequence;
+
+    std::atomic<uint64_t> update_ns;
+    std::atomic<int64_t> offset_ns;
+    std::atomic<uint64_t> frequency_bits;  /* double */
+    std::atomic<uint64_t> error_bound_bits; /* double */
+    std::atomic<uint32_t> state;
+    std::atomic<uint64_t> samples;
+    std::atomic<uint64_t> steps;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+              "shared_state_page needs address-free atomics");
+
+namespace shared_state_detail
+{
+    inline uint64_t to_bits(double value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    inline double from_bits(uint64_t bits)
+    {
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    inline size_t page_size()
+    {
+        long size = sysconf(_SC_PAGESIZE);
+        return size > 0 && (size_t)size >= sizeof(shared_state_page) ? (size_t)size : sizeof(shared_state_page);
+    }
+}
+
+class shared_state_publisher
+{
+public:
+    shared_state_publisher()
+        : page(nullptr),
+          size(0)
+    {}
+
+    ~shared_state_publisher()
+    {
+        close();
+    }
+
+    shared_state_publisher(const shared_state_publisher&) = delete;
+    shared_state_publisher& operator=(const shared_state_publisher&) = delete;
+
+    /* Create (or take over) the POSIX shared memory object, e.g. "/clock_discipliner" */
+    bool open(const char* name)
+    {
+        close();
+
+        int fd = shm_open(name, O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        size = shared_state_detail::page_size();
+        if (ftruncate(fd, (off_t)size) < 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+        {
+            return false;
+        }
+
+        page = static_cast<shared_state_page*>(mapped);
+        page->sequence.store(0, std::memory_order_relaxed);
+        page->version.store(shared_state_page::VERSION, std::memory_order_relaxed);
+        page->magic.store(shared_state_page::MAGIC, std::memory_order_release);
+        return true;
+    }
+
+    void close()
+    {
+        if (page != nullptr)
+        {
+            munmap(page, size);
+            page = nullptr;
+        }
+    }
+
+    bool is_open() const { return page != nullptr; }
+
+    /* Single writer only; wait-free */
+    void publish(const disciplined_state& s)
+    {
+        uint32_t sequence = page->sequence.load(std::memory_order_relaxed);
+        page->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        page->update_ns.store(s.update_ns, std::memory_order_relaxed);
+        page->offset_ns.store(s.offset_ns, std::memory_order_relaxed);
+        page->frequency_bits.store(shared_state_detail::to_bits(s.frequency_ppb), std::memory_order_relaxed);
+        page->error_bound_bits.store(shared_state_detail::to_bits(s.error_bound_ns), std::memory_order_relaxed);
+        page->state.store(s.state, std::memory_order_relaxed);
+        page->samples.store(s.samples, std::memory_order_relaxed);
+        page->steps.store(s.steps, std::memory_order_relaxed);
+
+        page->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /* Removes the name; mapped readers keep their page */
+    static bool unlink(const char* name)
+    {
+        return shm_unlink(name) == 0;
+    }
+
+private:
+    shared_state_page* page;
+    size_t size;
+};
+
+class shared_state_reader
+{
+public:
+    shared_state_reader()
+        : page(nullptr),
+          size(0)
+    {}
+
+    ~shared_state_reader()
+    {
+        close();
+    }
+
+    shared_state_reader(const shared_state_reader&) = delete;
+    shared_state_reader& operator=(const shared_state_reader&) = delete;
+
+    /* Maps the page read-only; false if missing or not a compatible publisher */
+    bool open(const char* name)
+    {
+        close();
+
+        int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(shared_state_page))
+        {
+            ::close(fd);
+            return false;
+        }
+
+        size = (size_t)st.st_size;
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+        {
+            return false;
+        }
+
+        page = static_cast<const shared_state_page*>(mapped);
+        if (page->magic.load(std::memory_order_acquire) != shared_state_page::MAGIC ||
+            page->version.load(std::memory_order_relaxed) != shared_state_page::VERSION)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if (page != nullptr)
+        {
+            munmap(const_cast<shared_state_page*>(page), size);
+            page = nullptr;
+        }
+    }
+
+    /*
+     * Copies a consistent snapshot. Returns false if nothing has been
+     * published yet, or if the writer kept the page busy for max_tries
+     * attempts.
+     */
+    bool read(disciplined_state& out, int max_tries = 1000) const
+    {
+        for (int attempt = 0; attempt < max_tries; ++attempt)
+        {
+            uint32_t before = page->sequence.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                continue;
+            }
+
+            out.update_ns = page->update_ns.load(std::memory_order_relaxed);
+            out.offset_ns = page->offset_ns.load(std::memory_order_relaxed);
+            out.frequency_ppb = shared_state_detail::from_bits(page->frequency_bits.load(std::memory_order_relaxed));
+            out.error_bound_ns = shared_state_detail::from_bits(page->error_bound_bits.load(std::memory_order_relaxed));
+            out.state = page->state.load(std::memory_order_relaxed);
+            out.samples = page->samples.load(std::memory_order_relaxed);
+            out.steps = page->steps.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (page->sequence.load(std::memory_order_relaxed) == before)
+            {
+                return before != 0;
+            }
+        }
+        return false;
+    }
+
+private:
+    const shared_state_page* page;
+    size_t size;
+};
+
+#endif // SHARED_STATE_H
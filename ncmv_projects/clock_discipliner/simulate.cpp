@@ -0,0 +1,778 @@
+#include "clock_discipliner.h"
+#include "clock_simulator.h"
+#include "source_selector.h"
+
+#include <chrono>
+#include <math.h>
+#include <random>
+#include <stdlib.h>
+#include <vector>
+
+/*
+ * Runs the discipliner against a simulated clock: no root, no sleeping.
+ *
+ *   clock_discipliner_sim [hours]
+ *
+ * First replays the test.cpp scenario with the discipline log on, then
+ * runs each discipline mode for a long scenario (default 24 simulated
+ * hours) and prints offset statistics against true time.
+ */
+
+static const int64_t NSEC_PER_MSEC = 1000000LL;
+static const int64_t NSEC_PER_SEC = 1000000000LL;
+
+/*
+ * GNSS-like source: emits exact true time every 100 ms; each message
+ * reaches the host after a base latency and the discipliner after a
+ * further delay following the accumulated test.cpp sleep jitter.
+ *
+ * With receive_timestamps the message is stamped on arrival at the host
+ * (as SO_TIMESTAMPNS would) and fed to on_time_sample(); otherwise the
+ * millisecond on_time_source_tick() API reads the clock on delivery.
+ */
+struct time_source
+{
+    clock_simulator& sim;
+    backend_clock_discipliner& discipliner;
+    std::vector<int> jitter_ms;
+    int64_t base_latency_ns;
+    bool receive_timestamps;
+    int64_t ticks_left;
+    int64_t ticks;
+    int64_t delay_ns;
+
+    void emit()
+    {
+        if (ticks_left-- <= 0)
+        {
+            return;
+        }
+
+        delay_ns += jitter_ms[ticks % jitter_ms.size()] * NSEC_PER_MSEC;
+        ticks++;
+
+        if (receive_timestamps)
+        {
+            uint64_t source_ns = (uint64_t)sim.now_ns();
+            int64_t delivery_ns = delay_ns;
+            sim.schedule_after(base_latency_ns, [this, source_ns, delivery_ns]()
+            {
+                struct timespec received;
+                sim.clock().gettime(&received);
+                sim.schedule_after(delivery_ns, [this, source_ns, received]() { discipliner.on_time_sample(source_ns, received); });
+            });
+        }
+        else
+        {
+            uint64_t source_ms = (uint64_t)(sim.now_ns() / NSEC_PER_MSEC);
+            sim.schedule_after(base_latency_ns + delay_ns, [this, source_ms]() { discipliner.on_time_source_tick(source_ms); });
+        }
+        sim.schedule_after(100 * NSEC_PER_MSEC, [this]() { emit(); });
+    }
+};
+
+struct scenario_result
+{
+    double convergence_s; /* time until the offset stays within 0.5 ms of its steady-state mean */
+    double mean_ns;       /* steady state: second half of the run */
+    double rms_ns;
+    double max_abs_ns;
+    uint64_t steps;
+    uint64_t adjtime_calls;
+    double wall_s;
+};
+
+/*
+ * Runs the simulation for duration_ns, sampling the true offset once per
+ * second, and summarizes it
+ */
+static scenario_result measure(clock_simulator& sim, int64_t duration_ns)
+{
+    /* True offset once per second */
+    std::vector<double> offsets;
+    offsets.reserve((size_t)(duration_ns / NSEC_PER_SEC) + 1);
+    std::function<void()> probe = [&]()
+    {
+        offsets.push_back(sim.clock().offset_ns());
+        sim.schedule_after(NSEC_PER_SEC, probe);
+    };
+    sim.schedule_after(NSEC_PER_SEC, probe);
+
+    auto start = std::chrono::steady_clock::now();
+    sim.run_for(duration_ns);
+
+    scenario_result result = {};
+    result.wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.steps = sim.clock().step_count();
+    result.adjtime_calls = sim.clock().adjtime_count();
+
+    size_t half = offsets.size() / 2;
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    for (size_t i = half; i < offsets.size(); ++i)
+    {
+        sum += offsets[i];
+        sum_squares += offsets[i] * offsets[i];
+        result.max_abs_ns = fmax(result.max_abs_ns, fabs(offsets[i]));
+    }
+    size_t count = offsets.size() - half;
+    result.mean_ns = count ? sum / count : 0.0;
+    result.rms_ns = count ? sqrt(sum_squares / count) : 0.0;
+
+    size_t settled = offsets.size();
+    while (settled > 0 && fabs(offsets[settled - 1] - result.mean_ns) < 0.5 * NSEC_PER_MSEC)
+    {
+        settled--;
+    }
+    result.convergence_s = (double)(settled + 1);
+    return result;
+}
+
+static scenario_result run_scenario(const clock_model& model, const discipline_config& config, double hours,
+                                    bool receive_timestamps = false, std::vector<stability_point>* stability = nullptr)
+{
+    clock_simulator sim(model);
+    backend_clock_discipliner discipliner(sim.clock(), config);
+    discipliner.set_log(nullptr);
+
+    const int64_t duration_ns = (int64_t)(hours * 3600.0 * NSEC_PER_SEC);
+    time_source source{sim, discipliner, {0, 0, 0, 0, 15, -15, 20, -20, 10, -10}, NSEC_PER_MSEC, receive_timestamps,
+                       duration_ns / (100 * NSEC_PER_MSEC), 0, 0};
+    source.emit();
+
+    scenario_result result = measure(sim, duration_ns);
+    if (stability != nullptr)
+    {
+        *stability = discipliner.stability().snapshot();
+    }
+    return result;
+}
+
+static void print_result(const char* name, const scenario_result& r, double hours)
+{
+    printf("  %-10s converged %7.0f s | steady offset mean %+8.3f ms, rms %7.3f ms, max %7.3f ms | steps %llu, adjtime %llu | %.0f h/s\n",
+           name, r.convergence_s, r.mean_ns / 1e6, r.rms_ns / 1e6, r.max_abs_ns / 1e6,
+           (unsigned long long)r.steps, (unsigned long long)r.adjtime_calls, hours / r.wall_s);
+}
+
+static void replay_test_scenario()
+{
+    printf("Replaying the test.cpp scenario on a simulated clock...\n");
+
+    clock_model model;
+    clock_simulator sim(model);
+    backend_clock_discipliner discipliner(sim.clock());
+
+    time_source source{sim, discipliner, {0, 0, 0, 0, 15, -15, 20, -20, 10, -10}, 0, false, 300, 0, 0};
+    source.emit();
+    sim.run_for(31 * NSEC_PER_SEC);
+
+    printf("true offset after %lld ticks: %.3f ms\n\n", (long long)source.ticks, sim.clock().offset_ns() / 1e6);
+}
+
+static void compare_modes(const char* title, const clock_model& model, double hours)
+{
+    printf("%s, %.1f simulated hours:\n", title, hours);
+
+    discipline_config ewma;
+    print_result("EWMA_SLEW", run_scenario(model, ewma, hours), hours);
+
+    discipline_config pi;
+    pi.mode = discipline_mode::PI_LOOP;
+    print_result("PI_LOOP", run_scenario(model, pi, hours), hours);
+}
+
+static void compare_ingest(const char* title, const clock_model& model, double hours)
+{
+    printf("%s, %.1f simulated hours:\n", title, hours);
+
+    discipline_config pi;
+    pi.mode = discipline_mode::PI_LOOP;
+    print_result("ms tick", run_scenario(model, pi, hours, false), hours);
+    print_result("ns + rx", run_scenario(model, pi, hours, true), hours);
+}
+
+static void compare_prefilters(const char* title, const clock_model& model, double hours)
+{
+    printf("%s, %.1f simulated hours:\n", title, hours);
+
+    const prefilter_mode modes[] = {prefilter_mode::NONE, prefilter_mode::MEDIAN, prefilter_mode::HAMPEL, prefilter_mode::MIN_DELAY};
+    const char* names[] = {"none", "median", "hampel", "min-delay"};
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i)
+    {
+        discipline_config config;
+        config.mode = discipline_mode::PI_LOOP;
+        config.prefilter.mode = modes[i];
+        print_result(names[i], run_scenario(model, config, hours), hours);
+    }
+}
+
+/*
+ * A pure frequency error with unbiased delivery: rx timestamps, no
+ * latency, no jitter. Whatever offset remains is the loop's own.
+ */
+static scenario_result run_unbiased(const clock_model& model, const discipline_config& config, double hours)
+{
+    clock_simulator sim(model);
+    backend_clock_discipliner discipliner(sim.clock(), config);
+    discipliner.set_log(nullptr);
+
+    const int64_t duration_ns = (int64_t)(hours * 3600.0 * NSEC_PER_SEC);
+    time_source source{sim, discipliner, {0}, 0, true, duration_ns / (100 * NSEC_PER_MSEC), 0, 0};
+    source.emit();
+    return measure(sim, duration_ns);
+}
+
+/* Same as print_result(), in microseconds: the residuals here are small */
+static void print_result_us(const char* name, const scenario_result& r, double hours)
+{
+    printf("  %-12s converged %5.0f s | steady offset mean %+9.3f us, rms %9.3f us, max %9.3f us | steps %llu | %.0f h/s\n",
+           name, r.convergence_s, r.mean_ns / 1e3, r.rms_ns / 1e3, r.max_abs_ns / 1e3, (unsigned long long)r.steps,
+           hours / r.wall_s);
+}
+
+static void compare_frequency_offsets(const char* title, clock_model model, double hours)
+{
+    printf("%s, %.1f simulated hours:\n", title, hours);
+
+    const double offsets_ppm[] = {10.0, 100.0};
+    for (size_t i = 0; i < sizeof(offsets_ppm) / sizeof(offsets_ppm[0]); ++i)
+    {
+        model.frequency_error_ppb = offsets_ppm[i] * 1000.0;
+        char name[32];
+
+        discipline_config ewma;
+        snprintf(name, sizeof(name), "EWMA %g ppm", offsets_ppm[i]);
+        print_result_us(name, run_unbiased(model, ewma, hours), hours);
+
+        discipline_config pi;
+        pi.mode = discipline_mode::PI_LOOP;
+        snprintf(name, sizeof(name), "PI %g ppm", offsets_ppm[i]);
+        print_result_us(name, run_unbiased(model, pi, hours), hours);
+    }
+}
+
+static void show_stability(const char* title, const clock_model& model, double hours)
+{
+    printf("%s, %.1f simulated hours:\n", title, hours);
+    printf("  %-10s %10s %12s %12s %12s\n", "", "tau (s)", "ADEV", "TDEV (ns)", "MTIE (ns)");
+
+    const prefilter_mode modes[] = {prefilter_mode::NONE, prefilter_mode::MIN_DELAY};
+    const char* names[] = {"none", "min-delay"};
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i)
+    {
+        discipline_config config;
+        config.mode = discipline_mode::PI_LOOP;
+        config.prefilter.mode = modes[i];
+        config.stability.octaves = 12;
+
+        std::vector<stability_point> points;
+        run_scenario(model, config, hours, false, &points);
+        for (size_t k = 0; k < points.size(); k += 2)
+        {
+            printf("  %-10s %10g %12.3e %12.0f %12.0f\n", k == 0 ? names[i] : "", points[k].tau_s, points[k].adev,
+                   points[k].tdev_ns, points[k].mtie_ns);
+        }
+    }
+
+    /* Estimator cost on its own, 12 octaves */
+    stability_config stats_config;
+    stats_config.octaves = 12;
+    stability_stats stats(stats_config);
+    const int samples = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < samples; ++i)
+    {
+        stats.add((int64_t)((i * 2654435761u) % 1000000));
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  stability_stats::add(): %.0f ns per sample over %zu octaves\n", elapsed / samples * 1e9, stats.octaves());
+}
+
+/*
+ * A source polled once per second. Two-way (NTP-like) sources see an
+ * exponentially distributed extra delay on each leg, which shows up as
+ * half the asymmetry in the offset; one-way (GNSS-like) sources see
+ * uniform timestamp noise. bias_ns makes a falseticker.
+ */
+struct peer_model
+{
+    const char* name;
+    int64_t bias_ns;
+    int64_t base_delay_ns;    /* per leg; 0 for a one-way source */
+    double mean_extra_delay_ns;
+    int64_t noise_ns;         /* one-way sources: +/- uniform */
+    int64_t error_bound_ns;
+};
+
+/*
+ * Polls every peer once per second and runs selection once per second,
+ * feeding the combined offset to the discipliner. With a single peer
+ * that is the same as trusting it alone.
+ */
+static scenario_result run_multi_source(const clock_model& model, const discipline_config& config, double hours,
+                                        const std::vector<peer_model>& peers, double* mean_survivors)
+{
+    clock_simulator sim(model);
+    backend_clock_discipliner discipliner(sim.clock(), config);
+    discipliner.set_log(nullptr);
+
+    source_selector selector;
+    for (const peer_model& peer : peers)
+    {
+        selector.add_source(peer.name, peer.error_bound_ns);
+    }
+
+    std::mt19937_64 random(1);
+    uint64_t selections = 0;
+    uint64_t survivors = 0;
+    std::function<void()> poll = [&]()
+    {
+        struct timespec ts;
+        sim.clock().gettime(&ts);
+        uint64_t local_ns = (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+        int64_t true_offset_ns = sim.now_ns() - (int64_t)local_ns;
+
+        for (size_t i = 0; i < peers.size(); ++i)
+        {
+            const peer_model& peer = peers[i];
+            if (peer.base_delay_ns > 0)
+            {
+                std::exponential_distribution<double> extra(1.0 / peer.mean_extra_delay_ns);
+                int64_t out_ns = peer.base_delay_ns + (int64_t)extra(random);
+                int64_t back_ns = peer.base_delay_ns + (int64_t)extra(random);
+                selector.on_sample(i, true_offset_ns + peer.bias_ns + (out_ns - back_ns) / 2, out_ns + back_ns, local_ns);
+            }
+            else
+            {
+                std::uniform_int_distribution<int64_t> noise(-peer.noise_ns, peer.noise_ns);
+                selector.on_sample(i, true_offset_ns + peer.bias_ns + noise(random), 0, local_ns);
+            }
+        }
+
+        selection_result selected = selector.select(local_ns);
+        if (selected.valid)
+        {
+            selections++;
+            survivors += selected.survivors;
+            int64_t stepped_ns = discipliner.on_offset_sample(selected.offset_ns, local_ns);
+            if (stepped_ns != 0)
+            {
+                selector.on_step(stepped_ns);
+            }
+        }
+        sim.schedule_after(NSEC_PER_SEC, poll);
+    };
+    sim.schedule_after(NSEC_PER_SEC, poll);
+
+    scenario_result result = measure(sim, (int64_t)(hours * 3600.0 * NSEC_PER_SEC));
+    *mean_survivors = selections ? (double)survivors / selections : 0.0;
+    return result;
+}
+
+static void compare_sources(const char* title, const clock_model& model, double hours)
+{
+    printf("%s, %.1f simulated hours:\n", title, hours);
+
+    const peer_model gnss = {"gnss", 0, 0, 0.0, 50000, 100000};
+    const peer_model ntp_a = {"ntp-a", 0, 2 * NSEC_PER_MSEC, 1e6, 0, 5 * NSEC_PER_MSEC};
+    const peer_model ntp_b = {"ntp-b", 0, 3 * NSEC_PER_MSEC, 2e6, 0, 5 * NSEC_PER_MSEC};
+    const peer_model ntp_bad = {"ntp-bad", 25 * NSEC_PER_MSEC, 2 * NSEC_PER_MSEC, 1e6, 0, 5 * NSEC_PER_MSEC};
+
+    discipline_config config;
+    config.mode = discipline_mode::PI_LOOP;
+
+    struct
+    {
+        const char* name;
+        std::vector<peer_model> peers;
+    } setups[] = {
+        {"ntp-bad", {ntp_bad}},
+        {"ntp-a", {ntp_a}},
+        {"gnss", {gnss}},
+        {"all four", {gnss, ntp_a, ntp_b, ntp_bad}},
+    };
+    for (const auto& setup : setups)
+    {
+        double mean_survivors;
+        print_result(setup.name, run_multi_source(model, config, hours, setup.peers, &mean_survivors), hours);
+        if (setup.peers.size() > 1)
+        {
+            printf("  %-10s %.2f survivors per selection on average\n", "", mean_survivors);
+        }
+    }
+
+    /* select() cost as the number of sources grows */
+    for (size_t n : {4, 16, 64, 256})
+    {
+        source_selector selector;
+        std::mt19937_64 random(2);
+        std::normal_distribution<double> spread(0.0, 1e5);
+        for (size_t i = 0; i < n; ++i)
+        {
+            selector.add_source("peer", NSEC_PER_MSEC);
+            for (int k = 0; k < 8; ++k)
+            {
+                int64_t bias = i % 5 == 4 ? 50 * NSEC_PER_MSEC : 0;
+                selector.on_sample(i, bias + (int64_t)spread(random), (int64_t)(2e6 + fabs(spread(random))), NSEC_PER_SEC);
+            }
+        }
+
+        const int rounds = 2000;
+        size_t kept = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; ++r)
+        {
+            kept = selector.select(NSEC_PER_SEC).survivors;
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("  select() over %3zu sources (every 5th false): %7.2f us, %zu survivors\n", n, elapsed / rounds * 1e6, kept);
+    }
+}
+
+/*
+ * 1 Hz GNSS-like source (+/- 50 us timestamp noise) that goes silent for
+ * outage_s after two hours, with check_source() polled every second as
+ * discipline_thread would. Reports the true offset at the end of the
+ * outage against the predicted holdover error, and how the return went.
+ */
+static void run_outage(const char* name, const clock_model& model, const discipline_config& config, double outage_s)
+{
+    clock_simulator sim(model);
+    backend_clock_discipliner discipliner(sim.clock(), config);
+    discipliner.set_log(nullptr);
+
+    const int64_t outage_start_ns = 2 * 3600 * NSEC_PER_SEC;
+    const int64_t outage_end_ns = outage_start_ns + (int64_t)(outage_s * NSEC_PER_SEC);
+    const int64_t end_ns = outage_end_ns + 3600 * NSEC_PER_SEC;
+
+    std::mt19937_64 random(3);
+    std::uniform_int_distribution<int64_t> noise(-50000, 50000);
+    int64_t start_ns = sim.now_ns();
+    double predicted_ns = 0.0;
+    double actual_ns = 0.0;
+    double worst_after_ns = 0.0;
+    double settled_s = 0.0;
+    uint64_t steps_before = 0;
+
+    std::function<void()> tick = [&]()
+    {
+        int64_t elapsed_ns = sim.now_ns() - start_ns;
+        if (elapsed_ns >= end_ns)
+        {
+            return;
+        }
+
+        if (elapsed_ns < outage_start_ns || elapsed_ns >= outage_end_ns)
+        {
+            if (elapsed_ns >= outage_end_ns)
+            {
+                if (predicted_ns == 0.0 && actual_ns == 0.0)
+                {
+                    predicted_ns = discipliner.holdover_error_ns();
+                    actual_ns = fabs(sim.clock().offset_ns());
+                    steps_before = sim.clock().step_count();
+                }
+                worst_after_ns = fmax(worst_after_ns, fabs(sim.clock().offset_ns()));
+                if (fabs(sim.clock().offset_ns()) > 0.2 * NSEC_PER_MSEC)
+                {
+                    settled_s = (double)(elapsed_ns - outage_end_ns) / NSEC_PER_SEC + 1.0;
+                }
+            }
+
+            struct timespec received;
+            sim.clock().gettime(&received);
+            discipliner.on_time_sample((uint64_t)(sim.now_ns() + noise(random)), received);
+        }
+
+        discipliner.check_source();
+        sim.schedule_after(NSEC_PER_SEC, tick);
+    };
+    sim.schedule_after(NSEC_PER_SEC, tick);
+    sim.run_for(end_ns + NSEC_PER_SEC);
+
+    printf("  %-22s at return: offset %8.3f ms, predicted %8.3f ms | after: steps %llu, max %8.3f ms, within 0.2 ms after %5.0f s\n",
+           name, actual_ns / 1e6, predicted_ns / 1e6, (unsigned long long)(sim.clock().step_count() - steps_before),
+           worst_after_ns / 1e6, settled_s);
+}
+
+/* PI_LOOP on the given model; EWMA_SLEW, which needs it, with the kernel PLL on */
+static void compare_holdover(const char* title, const clock_model& model)
+{
+    printf("%s:\n", title);
+
+    const double outages[] = {600.0, 3.0 * 3600.0};
+    const discipline_mode modes[] = {discipline_mode::PI_LOOP, discipline_mode::EWMA_SLEW};
+    for (discipline_mode mode : modes)
+    {
+        clock_model variant = model;
+        variant.kernel_pll = mode == discipline_mode::EWMA_SLEW;
+        for (double outage_s : outages)
+        {
+            for (int enabled = 0; enabled < 2; ++enabled)
+            {
+                discipline_config config;
+                config.mode = mode;
+                if (!enabled)
+                {
+                    config.holdover.timeout_s = 0.0;
+                }
+
+                char name[64];
+                snprintf(name, sizeof(name), "%s %3.0f min %s", mode == discipline_mode::PI_LOOP ? "PI" : "EWMA",
+                         outage_s / 60.0, enabled ? "holdover" : "off");
+                run_outage(name, variant, config, outage_s);
+            }
+        }
+    }
+}
+
+static void compare_polling(const char* title, const clock_model& model, double hours)
+{
+    printf("%s, %.1f simulated hours:\n", title, hours);
+
+    const discipline_mode modes[] = {discipline_mode::EWMA_SLEW, discipline_mode::PI_LOOP};
+    const char* names[][2] = {{"EWMA 1 Hz", "EWMA adapt"}, {"PI 1 Hz", "PI adapt"}};
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i)
+    {
+        clock_model m = model;
+        m.kernel_pll = modes[i] == discipline_mode::EWMA_SLEW; /* as in compare_holdover */
+        for (int adaptive = 0; adaptive < 2; ++adaptive)
+        {
+            discipline_config config;
+            config.mode = modes[i];
+            config.prefilter.mode = prefilter_mode::MIN_DELAY;
+            config.poll.adaptive = adaptive != 0;
+            print_result(names[i][adaptive], run_scenario(m, config, hours, true), hours);
+        }
+    }
+}
+
+/*
+ * One step from a 50 ms initial offset, per mode: what last_step()
+ * recorded, and where the clock is a minute later
+ */
+static void show_steps(const char* title, const clock_model& model)
+{
+    printf("%s:\n", title);
+
+    const discipline_mode modes[] = {discipline_mode::EWMA_SLEW, discipline_mode::PI_LOOP};
+    const char* names[] = {"EWMA_SLEW", "PI_LOOP"};
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i)
+    {
+        clock_simulator sim(model);
+        discipline_config config;
+        config.mode = modes[i];
+        config.prefilter.mode = prefilter_mode::MIN_DELAY;
+        backend_clock_discipliner discipliner(sim.clock(), config);
+        discipliner.set_log(nullptr);
+
+        time_source source{sim, discipliner, {0, 0, 0, 0, 15, -15, 20, -20, 10, -10}, NSEC_PER_MSEC, true, 600, 0, 0};
+        source.emit();
+        sim.run_for(60 * NSEC_PER_SEC);
+
+        const step_record& step = discipliner.last_step();
+        printf("  %-10s offset %+9.3f ms, stepped %+9.3f ms in %.2f us, first sample after %+7.3f ms | after 60 s: %+.3f ms, steps %llu\n",
+               names[i], step.pre_offset_ns / 1e6, step.step_ns / 1e6, step.latency_ns / 1e3, step.post_offset_ns / 1e6,
+               sim.clock().offset_ns() / 1e6, (unsigned long long)sim.clock().step_count());
+    }
+}
+
+/*
+ * The same step fed the way discipline_thread does: 10 Hz samples are
+ * timestamped on receipt and queued, and the queue is drained once per
+ * second. Samples drained after a step were received before it.
+ */
+struct batched_source
+{
+    clock_simulator& sim;
+    backend_clock_discipliner& discipliner;
+    bool batched;
+    int64_t ticks_left;
+    std::vector<std::pair<uint64_t, struct timespec>> queue;
+
+    void emit()
+    {
+        if (ticks_left-- <= 0)
+        {
+            return;
+        }
+
+        uint64_t source_ns = (uint64_t)sim.now_ns();
+        sim.schedule_after(NSEC_PER_MSEC, [this, source_ns]()
+        {
+            struct timespec received;
+            sim.clock().gettime(&received);
+            if (batched)
+            {
+                queue.push_back(std::make_pair(source_ns, received));
+            }
+            else
+            {
+                discipliner.on_time_sample(source_ns, received);
+            }
+        });
+        sim.schedule_after(100 * NSEC_PER_MSEC, [this]() { emit(); });
+    }
+
+    void drain()
+    {
+        for (const std::pair<uint64_t, struct timespec>& sample : queue)
+        {
+            discipliner.on_time_sample(sample.first, sample.second);
+        }
+        queue.clear();
+        sim.schedule_after(NSEC_PER_SEC, [this]() { drain(); });
+    }
+};
+
+static void show_batched_steps(const char* title, const clock_model& model)
+{
+    printf("%s:\n", title);
+
+    const discipline_mode modes[] = {discipline_mode::EWMA_SLEW, discipline_mode::PI_LOOP};
+    const char* names[] = {"EWMA_SLEW", "PI_LOOP"};
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i)
+    {
+        for (int batched = 0; batched <= 1; ++batched)
+        {
+            clock_simulator sim(model);
+            discipline_config config;
+            config.mode = modes[i];
+            backend_clock_discipliner discipliner(sim.clock(), config);
+            discipliner.set_log(nullptr);
+
+            batched_source source{sim, discipliner, batched != 0, 600, {}};
+            source.emit();
+            sim.schedule_after(NSEC_PER_SEC, [&source]() { source.drain(); });
+            sim.run_for(60 * NSEC_PER_SEC);
+
+            const step_record& step = discipliner.last_step();
+            printf("  %-10s %-13s steps %llu, last %+9.3f ms, %2llu stale samples dropped, first after %+7.3f ms | after 60 s: %+.3f ms\n",
+                   names[i], batched ? "drained 1 Hz" : "direct", (unsigned long long)sim.clock().step_count(),
+                   step.step_ns / 1e6, (unsigned long long)step.stale_samples, step.post_offset_ns / 1e6,
+                   sim.clock().offset_ns() / 1e6);
+        }
+    }
+}
+
+/*
+ * A leap second pending (STA_INS) while the discipliner tracks for ten
+ * minutes, holds over for a minute and tracks again: it must survive
+ * every status write, as must the STA_PLL/STA_FREQHOLD the kernel had.
+ */
+static int read_status(clock_simulator& sim)
+{
+    struct timex tx;
+    memset(&tx, 0, sizeof(tx));
+    sim.clock().adjtime(&tx);
+    return tx.status;
+}
+
+static void show_status_bits(const char* title, const clock_model& model)
+{
+    printf("%s:\n", title);
+
+    const discipline_mode modes[] = {discipline_mode::EWMA_SLEW, discipline_mode::PI_LOOP};
+    const char* names[] = {"EWMA_SLEW", "PI_LOOP"};
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); ++i)
+    {
+        clock_simulator sim(model);
+        discipline_config config;
+        config.mode = modes[i];
+        backend_clock_discipliner discipliner(sim.clock(), config);
+        discipliner.set_log(nullptr);
+
+        struct timex tx;
+        memset(&tx, 0, sizeof(tx));
+        tx.modes = ADJ_STATUS;
+        tx.status = read_status(sim) | STA_INS;
+        sim.clock().adjtime(&tx);
+        const int initial = read_status(sim);
+
+        const int64_t outage_start_ns = 600 * NSEC_PER_SEC;
+        const int64_t outage_end_ns = outage_start_ns + 60 * NSEC_PER_SEC;
+        const int64_t end_ns = outage_end_ns + 600 * NSEC_PER_SEC;
+        int tracking = 0;
+        int holdover = 0;
+        int64_t start_ns = sim.now_ns();
+        std::function<void()> tick = [&]()
+        {
+            int64_t elapsed_ns = sim.now_ns() - start_ns;
+            if (elapsed_ns >= end_ns)
+            {
+                return;
+            }
+            if (elapsed_ns == outage_start_ns)
+            {
+                tracking = read_status(sim);
+            }
+            if (elapsed_ns == outage_end_ns - NSEC_PER_SEC)
+            {
+                holdover = read_status(sim);
+            }
+            if (elapsed_ns < outage_start_ns || elapsed_ns >= outage_end_ns)
+            {
+                struct timespec received;
+                sim.clock().gettime(&received);
+                discipliner.on_time_sample((uint64_t)sim.now_ns(), received);
+            }
+            discipliner.check_source();
+            sim.schedule_after(NSEC_PER_SEC, tick);
+        };
+        sim.schedule_after(NSEC_PER_SEC, tick);
+        sim.run_for(end_ns + NSEC_PER_SEC);
+        const int back = read_status(sim);
+
+        printf("  %-10s STA_INS initially %d, tracking %d, holdover %d, back %d | STA_PLL %d -> %d, STA_FREQHOLD %d -> %d\n",
+               names[i], (initial & STA_INS) != 0, (tracking & STA_INS) != 0, (holdover & STA_INS) != 0,
+               (back & STA_INS) != 0, (initial & STA_PLL) != 0, (back & STA_PLL) != 0, (initial & STA_FREQHOLD) != 0,
+               (back & STA_FREQHOLD) != 0);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    double hours = argc > 1 ? atof(argv[1]) : 24.0;
+
+    replay_test_scenario();
+
+    clock_model model;
+    model.initial_offset_ns = 2.0 * NSEC_PER_MSEC;
+    model.frequency_error_ppb = 10000.0;
+    model.wander_ppb = 1.0;
+    /* Both modes settle on the same -4.3 ms here: that is the bias of the test.cpp delivery jitter, not the loop */
+    compare_modes("10 ppm oscillator, 1 ppb/s wander, 2 ms initial offset, kernel PLL on", model, hours);
+
+    clock_model fixed = model;
+    fixed.wander_ppb = 0.0;
+    compare_frequency_offsets("Frequency error only, rx timestamps, no latency or jitter, kernel PLL on", fixed, hours);
+    fixed.kernel_pll = false;
+    compare_frequency_offsets("Same, kernel PLL off", fixed, hours);
+
+    model.kernel_pll = false;
+    compare_modes("Same, kernel PLL off (ADJ_OFFSET ignored unless STA_PLL is set)", model, hours);
+
+    compare_ingest("PI_LOOP, kernel PLL off, 1 ms network latency", model, hours);
+
+    compare_prefilters("PI_LOOP, ms ticks with test.cpp delivery jitter, by pre-filter", model, hours);
+
+    show_stability("Measured offset stability, PI_LOOP, ms ticks", model, hours);
+
+    compare_sources("PI_LOOP, kernel PLL off, 1 Hz polls, ntp-bad is 25 ms off", model, hours);
+
+    compare_holdover("Source outage after 2 h, 10 ppm oscillator, 1 ppb/s wander (PI: kernel PLL off, EWMA: on)", model);
+
+    compare_polling("Fixed 1 Hz vs adaptive discipline interval, min-delay, 1 ms latency (PI: kernel PLL off, EWMA: on)",
+                    model, hours);
+
+    model.initial_offset_ns = -50.0 * NSEC_PER_MSEC;
+    model.kernel_pll = true;
+    show_steps("ADJ_SETOFFSET step from 50 ms behind, min-delay, 1 ms latency, kernel PLL on", model);
+
+    show_batched_steps("Step from 50 ms behind, 10 Hz samples fed directly vs drained once per second", model);
+
+    model.initial_offset_ns = 2.0 * NSEC_PER_MSEC;
+    show_status_bits("Kernel status bits kept through tracking, a 60 s outage and the return, kernel PLL on", model);
+    return 0;
+}
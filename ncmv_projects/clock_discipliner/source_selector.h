@@ -0,0 +1,479 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SOURCE_SELECTOR_H
+#define SOURCE_SELECTOR_H
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+ * Multi-source selection and combining, after the NTPv4 algorithms
+ * (RFC 5905 section 11.2)
+ *
+ * - Clock filter: each source keeps its last filter_window samples; its
+ *   estimate is the lowest-delay recent sample, its jitter the RMS
+ *   distance of the other samples from it
+ * - Selection: each source claims the true time lies within its offset
+ *   +/- root distance (half the delay, the configured error bound, the
+ *   jitter and 15 ppm of sample age). Sources whose interval misses the
+ *   intersection agreed by a majority are falsetickers
+ * - Clustering: the truechimer farthest from the others (largest
+ *   selection jitter) is dropped until min_survivors remain or the
+ *   spread is below the best source's own jitter
+ * - Combining: survivors are averaged with inverse-variance weights
+ *   from their jitter
+ *
+ * select() is O(n log n): the intersection scan is binary searched over
+ * the number of falsetickers allowed, and since selection jitter is a
+ * convex function of offset the clustering victim is always the highest
+ * or lowest survivor.
+ *
+ * Offsets are source minus local, as in clock_discipliner.
+ */
+
+struct source_selector_config
+{
+    size_t filter_window = 8;                   /* samples per source, as NTP's clock filter */
+    size_t min_survivors = 3;                   /* clustering stops here (NTP MINCLUST) */
+    int64_t max_age_ns = 64LL * 1000000000LL;   /* older samples are ignored */
+    double min_jitter_ns = 1000.0;              /* weight floor: no source is trusted below 1 us */
+};
+
+/* Current view of one source */
+struct source_estimate
+{
+    bool usable;              /* has a sample younger than max_age_ns */
+    int64_t offset_ns;
+    int64_t delay_ns;
+    double jitter_ns;
+    double root_distance_ns;
+    bool truechimer;          /* set by the last select() */
+    bool survivor;
+};
+
+struct selection_result
+{
+    bool valid;           /* false without a majority of agreeing sources */
+    int64_t offset_ns;    /* combined offset of the survivors */
+    double jitter_ns;     /* weighted RMS spread of the survivors */
+    size_t candidates;
+    size_t truechimers;
+    size_t survivors;
+};
+
+class source_selector
+{
+public:
+    explicit source_selector(const source_selector_config& config = source_selector_config())
+        : cfg(config)
+    {
+        if (cfg.filter_window == 0)
+        {
+            cfg.filter_window = 1;
+        }
+        if (cfg.min_survivors == 0)
+        {
+            cfg.min_survivors = 1;
+        }
+    }
+
+    /*
+     * error_bound_ns: how far the source itself may be from true time
+     * (receiver accuracy, or the peer's root distance). Returns the id
+     * to pass to on_sample().
+     */
+    size_t add_source(const char* name, int64_t error_bound_ns)
+    {
+        source s;
+        s.name = name;
+        s.error_bound_ns = error_bound_ns;
+        s.next = 0;
+        s.estimate = source_estimate();
+        sources.push_back(s);
+        return sources.size() - 1;
+    }
+
+    /*
+     * offset_ns: source minus local clock
+     * delay_ns: round-trip delay, 0 for one-way sources
+     * receive_ns: local clock at reception
+     */
+    void on_sample(size_t id, int64_t offset_ns, int64_t delay_ns, uint64_t receive_ns)
+    {
+        source& s = sources[id];
+        sample entry = {offset_ns, delay_ns < 0 ? 0 : delay_ns, receive_ns};
+        if (s.samples.size() < cfg.filter_window)
+        {
+            s.samples.push_back(entry);
+        }
+        else
+        {
+            s.samples[s.next] = entry;
+            s.next = (s.next + 1) % cfg.filter_window;
+        }
+    }
+
+    /* One-way source such as GNSS: absolute source time and receive time */
+    void on_time_sample(size_t id, uint64_t source_ns, uint64_t receive_ns)
+    {
+        on_sample(id, (int64_t)(source_ns - receive_ns), 0, receive_ns);
+    }
+
+    /*
+     * The local clock was stepped by step_ns: shift stored offsets so the
+     * filters stay valid
+     */
+    void on_step(int64_t step_ns)
+    {
+        for (source& s : sources)
+        {
+            for (sample& e : s.samples)
+            {
+                e.offset_ns -= step_ns;
+                e.receive_ns += (uint64_t)step_ns;
+            }
+        }
+    }
+
+    /* Run once per discipline interval; now_ns is the local clock */
+    selection_result select(uint64_t now_ns)
+    {
+        selection_result result = {false, 0, 0.0, 0, 0, 0};
+
+        candidates.clear();
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            update_estimate(sources[i], now_ns);
+            if (sources[i].estimate.usable)
+            {
+                candidates.push_back(i);
+            }
+        }
+        result.candidates = candidates.size();
+        if (candidates.empty())
+        {
+            return result;
+        }
+
+        int64_t low;
+        int64_t high;
+        if (!intersect(low, high))
+        {
+            return result;
+        }
+
+        /* Truechimers, ordered by offset */
+        survivors.clear();
+        for (size_t id : candidates)
+        {
+            source_estimate& e = sources[id].estimate;
+            int64_t distance = (int64_t)ceil(e.root_distance_ns);
+            if (e.offset_ns + distance >= low && e.offset_ns - distance <= high)
+            {
+                e.truechimer = true;
+                survivors.push_back(id);
+            }
+        }
+        result.truechimers = survivors.size();
+        if (survivors.empty())
+        {
+            return result;
+        }
+        std::sort(survivors.begin(), survivors.end(), [this](size_t a, size_t b)
+        {
+            return sources[a].estimate.offset_ns < sources[b].estimate.offset_ns;
+        });
+
+        size_t first;
+        size_t last;
+        cluster(first, last);
+
+        /* Inverse-variance combination */
+        int64_t reference = sources[survivors[first]].estimate.offset_ns;
+        double weight_sum = 0.0;
+        double weighted = 0.0;
+        for (size_t i = first; i < last; ++i)
+        {
+            source_estimate& e = sources[survivors[i]].estimate;
+            e.survivor = true;
+            double jitter = std::max(e.jitter_ns, cfg.min_jitter_ns);
+            double w = 1.0 / (jitter * jitter);
+            weight_sum += w;
+            weighted += w * (double)(e.offset_ns - reference);
+        }
+        double mean = weighted / weight_sum;
+
+        double spread = 0.0;
+        for (size_t i = first; i < last; ++i)
+        {
+            const source_estimate& e = sources[survivors[i]].estimate;
+            double jitter = std::max(e.jitter_ns, cfg.min_jitter_ns);
+            double d = (double)(e.offset_ns - reference) - mean;
+            spread += d * d / (jitter * jitter);
+        }
+
+        result.valid = true;
+        result.offset_ns = reference + (int64_t)llround(mean);
+        result.jitter_ns = sqrt(spread / weight_sum);
+        result.survivors = last - first;
+        return result;
+    }
+
+    size_t size() const { return sources.size(); }
+    const char* name(size_t id) const { return sources[id].name.c_str(); }
+    const source_estimate& estimate(size_t id) const { return sources[id].estimate; }
+
+private:
+    struct sample
+    {
+        int64_t offset_ns;
+        int64_t delay_ns;
+        uint64_t receive_ns;
+    };
+
+    struct source
+    {
+        std::string name;
+        int64_t error_bound_ns;
+        std::vector<sample> samples;
+        size_t next;
+        source_estimate estimate;
+    };
+
+    /* Interval endpoint: type -1 lower, +1 upper */
+    struct endpoint
+    {
+        int64_t value;
+        int type;
+
+        bool operator<(const endpoint& other) const
+        {
+            return value != other.value ? value < other.value : type < other.type;
+        }
+    };
+
+    static constexpr double PHI = 15e-6; /* frequency tolerance, for dispersion growth with age */
+
+    source_selector_config cfg;
+    std::vector<source> sources;
+    std::vector<size_t> candidates;
+    std::vector<size_t> survivors;
+    std::vector<endpoint> endpoints;
+
+    bool is_stale(const sample& x, uint64_t now_ns) const
+    {
+        return now_ns > x.receive_ns && now_ns - x.receive_ns > (uint64_t)cfg.max_age_ns;
+    }
+
+    void update_estimate(source& s, uint64_t now_ns)
+    {
+        source_estimate& e = s.estimate;
+        e = source_estimate();
+
+        const sample* best = nullptr;
+        for (const sample& x : s.samples)
+        {
+            if (is_stale(x, now_ns))
+            {
+                continue;
+            }
+            if (best == nullptr || x.delay_ns < best->delay_ns)
+            {
+                best = &x;
+            }
+        }
+        if (best == nullptr)
+        {
+            return;
+        }
+
+        double sum_squares = 0.0;
+        size_t others = 0;
+        for (const sample& x : s.samples)
+        {
+            if (&x != best && !is_stale(x, now_ns))
+            {
+                double d = (double)(x.offset_ns - best->offset_ns);
+                sum_squares += d * d;
+                others++;
+            }
+        }
+
+        double age_ns = now_ns > best->receive_ns ? (double)(now_ns - best->receive_ns) : 0.0;
+
+        e.usable = true;
+        e.offset_ns = best->offset_ns;
+        e.delay_ns = best->delay_ns;
+        e.jitter_ns = others ? sqrt(sum_squares / others) : 0.0;
+        e.root_distance_ns = best->delay_ns / 2.0 + (double)s.error_bound_ns + e.jitter_ns + PHI * age_ns;
+    }
+
+    /*
+     * Interval [low, high] inside all but `allow` candidate intervals, for
+     * the smallest allow that works, with fewer than half the candidates
+     * lying. Endpoints are sorted once; whether `allow` works is
+     * monotonic in allow, so it is binary searched.
+     *
+     * Unlike RFC 5905, a midpoint outside the intersection does not count
+     * against a source whose interval covers it (as in later ntpd and
+     * chrony): with one tight source that rule rejected honest peers.
+     */
+    bool intersect(int64_t& low, int64_t& high)
+    {
+        endpoints.clear();
+        for (size_t id : candidates)
+        {
+            const source_estimate& e = sources[id].estimate;
+            int64_t distance = (int64_t)ceil(e.root_distance_ns);
+            endpoints.push_back(endpoint{e.offset_ns - distance, -1});
+            endpoints.push_back(endpoint{e.offset_ns + distance, 1});
+        }
+        std::sort(endpoints.begin(), endpoints.end());
+
+        size_t n = candidates.size();
+        size_t lo = 0;
+        size_t hi = (n - 1) / 2; /* most falsetickers that still leaves a majority */
+        if (!try_allow(hi, low, high))
+        {
+            return false;
+        }
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            int64_t l = 0;
+            int64_t h = 0;
+            if (try_allow(mid, l, h))
+            {
+                hi = mid;
+            }
+            else
+            {
+                lo = mid + 1;
+            }
+        }
+        return try_allow(lo, low, high);
+    }
+
+    bool try_allow(size_t allow, int64_t& low, int64_t& high) const
+    {
+        const long needed = (long)(candidates.size() - allow);
+        long chime = 0;
+        bool have_low = false;
+        for (size_t i = 0; i < endpoints.size(); ++i)
+        {
+            chime -= endpoints[i].type;
+            if (chime >= needed)
+            {
+                low = endpoints[i].value;
+                have_low = true;
+                break;
+            }
+        }
+
+        chime = 0;
+        bool have_high = false;
+        for (size_t i = endpoints.size(); i-- > 0;)
+        {
+            chime += endpoints[i].type;
+            if (chime >= needed)
+            {
+                high = endpoints[i].value;
+                have_high = true;
+                break;
+            }
+        }
+
+        return have_low && have_high && low <= high;
+    }
+
+    /*
+     * Trim survivors[first, last) from the ends. Selection jitter of x
+     * against the rest, sum (x - y)^2, is convex in x, so the worst
+     * survivor is always at one end. Running sums give each in O(1);
+     * the best peer jitter comes from a multiset.
+     */
+    void cluster(size_t& first, size_t& last)
+    {
+        first = 0;
+        last = survivors.size();
+
+        int64_t reference = sources[survivors[0]].estimate.offset_ns;
+        double sum = 0.0;
+        double sum_squares = 0.0;
+        std::multiset<double> jitters;
+        for (size_t id : survivors)
+        {
+            const source_estimate& e = sources[id].estimate;
+            double x = (double)(e.offset_ns - reference);
+            sum += x;
+            sum_squares += x * x;
+            jitters.insert(e.jitter_ns);
+        }
+
+        while (last - first > cfg.min_survivors)
+        {
+            double k = (double)(last - first);
+            const source_estimate& lowest = sources[survivors[first]].estimate;
+            const source_estimate& highest = sources[survivors[last - 1]].estimate;
+            double x_low = (double)(lowest.offset_ns - reference);
+            double x_high = (double)(highest.offset_ns - reference);
+
+            /* sum over the others of (x - y)^2 = k x^2 - 2 x sum + sum_squares */
+            double phi_low = sqrt(std::max(0.0, (k * x_low * x_low - 2.0 * x_low * sum + sum_squares) / (k - 1.0)));
+            double phi_high = sqrt(std::max(0.0, (k * x_high * x_high - 2.0 * x_high * sum + sum_squares) / (k - 1.0)));
+
+            bool drop_low = phi_low > phi_high;
+            double phi_max = drop_low ? phi_low : phi_high;
+            if (phi_max <= *jitters.begin())
+            {
+                break;
+            }
+
+            const source_estimate& victim = drop_low ? lowest : highest;
+            double x = drop_low ? x_low : x_high;
+            sum -= x;
+            sum_squares -= x * x;
+            jitters.erase(jitters.find(victim.jitter_ns));
+            if (drop_low)
+            {
+                first++;
+            }
+            else
+            {
+                last--;
+            }
+        }
+    }
+};
+
+#endif // SOURCE_SELECTOR_H
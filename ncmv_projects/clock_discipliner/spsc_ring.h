@@ -0,0 +1,121 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#pragma once
+
+#include <stddef.h>
+
+#include <atomic>
+
+/*
+ * Single-producer single-consumer ring buffer
+ *
+ * - try_push() is wait-free: a fixed number of steps, failing rather
+ *   than waiting when the ring is full
+ * - pop_batch() drains up to N items with one acquire load and one
+ *   release store
+ * - Each side keeps a cached copy of the other side's index, so the
+ *   shared cache lines are only touched when the cache runs out
+ */
+
+template<typename T, size_t Capacity>
+class spsc_ring
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    spsc_ring()
+        : tail(0),
+          cached_head(0),
+          head(0),
+          cached_tail(0)
+    {}
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    /* Producer thread only */
+    bool try_push(const T& item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head == Capacity)
+        {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head == Capacity)
+            {
+                return false;
+            }
+        }
+
+        slots[t & (Capacity - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* Consumer thread only; returns the number of items copied to out */
+    size_t pop_batch(T* out, size_t max)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (cached_tail == h)
+        {
+            cached_tail = tail.load(std::memory_order_acquire);
+        }
+
+        size_t count = cached_tail - h;
+        if (count > max)
+        {
+            count = max;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = slots[(h + i) & (Capacity - 1)];
+        }
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    bool try_pop(T& out)
+    {
+        return pop_batch(&out, 1) == 1;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    /* Producer side */
+    alignas(64) std::atomic<size_t> tail;
+    size_t cached_head;
+
+    /* Consumer side */
+    alignas(64) std::atomic<size_t> head;
+    size_t cached_tail;
+
+    alignas(64) T slots[Capacity];
+};
+
+#endif // SPSC_RING_H
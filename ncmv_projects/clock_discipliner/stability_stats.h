@@ -0,0 +1,243 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef STABILITY_STATS_H
+#define STABILITY_STATS_H
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <math.h>
+
+#include <deque>
+#include <vector>
+
+/*
+ * Streaming clock stability statistics
+ *
+ * Fed one time-error (phase) sample x_n per sample interval tau0, and
+ * evaluated at tau = m * tau0 for m = 1, 2, 4, ... 2^(octaves - 1):
+ *
+ * - ADEV: overlapping Allan deviation,
+ *         AVAR = < (x[i+2m] - 2x[i+m] + x[i])^2 > / (2 tau^2)
+ * - TDEV: time deviation,
+ *         TVAR = < (S[i+2m] - 2S[i+m] + S[i])^2 > / (6 m^2),
+ *         where S[j] is the sum of the m samples starting at j
+ * - MTIE: largest peak-to-peak time error in any window of tau
+ *
+ * Every term uses the newest sample, so each octave costs O(1) per
+ * sample: window sums come from a ring of running sums, and MTIE keeps
+ * monotonic min/max deques (O(1) amortized). Memory is bounded by the
+ * largest tau: a ring of 3 * 2^(octaves - 1) samples plus the deques.
+ *
+ * The estimators assume evenly spaced samples; irregular arrival shows up
+ * as phase noise.
+ */
+
+struct stability_config
+{
+    double sample_interval_s = 0.1; /* tau0: a 10 Hz source */
+    size_t octaves = 0;             /* off in clock_discipliner; 12 covers tau0 .. 2048 tau0 */
+};
+
+struct stability_point
+{
+    double tau_s;
+    double adev;      /* fractional frequency, dimensionless */
+    double tdev_ns;
+    double mtie_ns;
+    uint64_t terms;   /* ADEV terms averaged; 0 until 2m + 1 samples */
+};
+
+class stability_stats
+{
+public:
+    explicit stability_stats(const stability_config& config = stability_config())
+        : tau0(config.sample_interval_s),
+          levels(config.octaves < 1 ? 1 : (config.octaves > 24 ? 24 : config.octaves)),
+          mask(0),
+          count(0)
+    {
+        size_t needed = 3 * ((size_t)1 << (levels - 1)) + 1;
+        size_t size = 1;
+        while (size < needed)
+        {
+            size <<= 1;
+        }
+        mask = size - 1;
+        phase.assign(size, 0);
+        running_sum.assign(size, 0);
+        octave.resize(levels);
+    }
+
+    void add(int64_t phase_ns)
+    {
+        const uint64_t n = count;
+        const uint64_t previous_sum = n > 0 ? running_sum[(n - 1) & mask] : 0;
+        phase[n & mask] = phase_ns;
+        running_sum[n & mask] = previous_sum + (uint64_t)phase_ns; /* wraps; differences stay exact */
+        count++;
+
+        for (size_t k = 0; k < levels; ++k)
+        {
+            const uint64_t m = (uint64_t)1 << k;
+            level& l = octave[k];
+
+            if (n >= 2 * m)
+            {
+                double d = (double)(phase_ns - 2 * x(n - m) + x(n - 2 * m));
+                l.adev_sum += d * d;
+                l.adev_terms++;
+            }
+
+            if (n + 1 >= 3 * m)
+            {
+                /* Window sums of [n-3m+1, n-2m], [n-2m+1, n-m], [n-m+1, n] */
+                int64_t newest = window_sum(n, m);
+                int64_t middle = window_sum(n - m, m);
+                int64_t oldest = window_sum(n - 2 * m, m);
+                double d = (double)newest - 2.0 * (double)middle + (double)oldest;
+                l.tdev_sum += d * d;
+                l.tdev_terms++;
+            }
+
+            /* MTIE: the window of tau spans m + 1 samples */
+            while (!l.highest.empty() && x(l.highest.back()) <= phase_ns)
+            {
+                l.highest.pop_back();
+            }
+            l.highest.push_back(n);
+            while (!l.lowest.empty() && x(l.lowest.back()) >= phase_ns)
+            {
+                l.lowest.pop_back();
+            }
+            l.lowest.push_back(n);
+
+            if (n >= m)
+            {
+                while (l.highest.front() < n - m)
+                {
+                    l.highest.pop_front();
+                }
+                while (l.lowest.front() < n - m)
+                {
+                    l.lowest.pop_front();
+                }
+
+                double spread = (double)x(l.highest.front()) - (double)x(l.lowest.front());
+                if (spread > l.mtie_ns)
+                {
+                    l.mtie_ns = spread;
+                }
+            }
+        }
+    }
+
+    size_t octaves() const { return levels; }
+    uint64_t samples() const { return count; }
+
+    stability_point at(size_t k) const
+    {
+        const level& l = octave[k];
+        const double m = (double)((uint64_t)1 << k);
+
+        stability_point p;
+        p.tau_s = m * tau0;
+        p.adev = l.adev_terms ? sqrt(l.adev_sum / l.adev_terms / 2.0) / p.tau_s * 1e-9 : 0.0;
+        p.tdev_ns = l.tdev_terms ? sqrt(l.tdev_sum / l.tdev_terms / 6.0) / m : 0.0;
+        p.mtie_ns = l.mtie_ns;
+        p.terms = l.adev_terms;
+        return p;
+    }
+
+    std::vector<stability_point> snapshot() const
+    {
+        std::vector<stability_point> points;
+        for (size_t k = 0; k < levels; ++k)
+        {
+            points.push_back(at(k));
+        }
+        return points;
+    }
+
+    /* One row per tau that has at least one ADEV term */
+    void write_csv(FILE* out) const
+    {
+        fprintf(out, "tau_s,adev,tdev_ns,mtie_ns,terms\n");
+        for (size_t k = 0; k < levels; ++k)
+        {
+            stability_point p = at(k);
+            if (p.terms == 0)
+            {
+                break;
+            }
+            fprintf(out, "%g,%.6e,%.3f,%.0f,%llu\n", p.tau_s, p.adev, p.tdev_ns, p.mtie_ns, (unsigned long long)p.terms);
+        }
+    }
+
+    void reset()
+    {
+        count = 0;
+        for (level& l : octave)
+        {
+            l = level();
+        }
+    }
+
+private:
+    struct level
+    {
+        double adev_sum = 0.0;
+        uint64_t adev_terms = 0;
+        double tdev_sum = 0.0;
+        uint64_t tdev_terms = 0;
+        double mtie_ns = 0.0;
+        std::deque<uint64_t> highest; /* sample numbers, decreasing phase */
+        std::deque<uint64_t> lowest;  /* sample numbers, increasing phase */
+    };
+
+    int64_t x(uint64_t n) const
+    {
+        return phase[n & mask];
+    }
+
+    /* Sum of the m samples ending at sample `last` */
+    int64_t window_sum(uint64_t last, uint64_t m) const
+    {
+        uint64_t before = last >= m ? running_sum[(last - m) & mask] : 0;
+        return (int64_t)(running_sum[last & mask] - before);
+    }
+
+    const double tau0;
+    const size_t levels;
+    uint64_t mask;
+    uint64_t count;
+    std::vector<int64_t> phase;
+    std::vector<uint64_t> running_sum; /* running_sum[n] = x[0] + ... + x[n], mod 2^64 */
+    std::vector<level> octave;
+};
+
+#endif // STABILITY_STATS_H
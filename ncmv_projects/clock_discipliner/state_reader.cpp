@@ -0,0 +1,87 @@
+#include "shared_state.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Prints the discipline state another process publishes.
+ *
+ *   clock_state_read [--bench N] [NAME]
+ *
+ * NAME defaults to /clock_discipliner. --bench times N snapshot reads.
+ */
+
+static const char* state_name(uint32_t state)
+{
+    switch (state)
+    {
+        case 0: return "tracking";
+        case 1: return "holdover";
+        case 2: return "reacquiring";
+        default: return "unknown";
+    }
+}
+
+static uint64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* name = "/clock_discipliner";
+    long bench = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc)
+        {
+            bench = atol(argv[++i]);
+        }
+        else
+        {
+            name = argv[i];
+        }
+    }
+
+    shared_state_reader reader;
+    if (!reader.open(name))
+    {
+        fprintf(stderr, "%s: no published discipline state\n", name);
+        return 1;
+    }
+
+    disciplined_state s;
+    if (!reader.read(s))
+    {
+        fprintf(stderr, "%s: nothing published yet\n", name);
+        return 1;
+    }
+
+    printf("state        %s\n", state_name(s.state));
+    printf("updated      %llu.%09llu\n", (unsigned long long)(s.update_ns / 1000000000ULL),
+           (unsigned long long)(s.update_ns % 1000000000ULL));
+    printf("offset       %+.6f ms\n", s.offset_ns / 1e6);
+    printf("frequency    %+.3f ppm\n", s.frequency_ppb / 1e3);
+    printf("error bound  %.6f ms\n", s.error_bound_ns / 1e6);
+    printf("samples      %llu\n", (unsigned long long)s.samples);
+    printf("steps        %llu\n", (unsigned long long)s.steps);
+
+    if (bench > 0)
+    {
+        uint64_t start = monotonic_ns();
+        uint64_t checksum = 0;
+        for (long i = 0; i < bench; ++i)
+        {
+            reader.read(s);
+            checksum += s.samples;
+        }
+        uint64_t elapsed = monotonic_ns() - start;
+        printf("read()       %.1f ns per snapshot over %ld reads (checksum %llu)\n", (double)elapsed / bench, bench,
+               (unsigned long long)checksum);
+    }
+    return 0;
+}
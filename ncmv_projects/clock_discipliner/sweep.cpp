@@ -0,0 +1,265 @@
+#include "replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/*
+ * Evaluates a grid of discipliner parameters against a capture, in
+ * parallel, and ranks them.
+ *
+ *   clock_discipliner_sweep [options] [CAPTURE]
+ *
+ *   --hours H           length of the synthetic capture used without
+ *                       CAPTURE (default 6): the test.cpp 10 Hz source
+ *                       with its delivery jitter and 1 ms latency
+ *   --write-capture F   save the synthetic capture to F
+ *   --threads N         worker threads (default: all cores)
+ *   --sort rms|max|steps
+ *   --top N             rows to print (default 20)
+ *   --frequency-ppb X   simulated oscillator error (default 10000)
+ *   --wander-ppb X      per-second random-walk frequency step (default 1)
+ *   --no-kernel-pll     simulate a kernel with STA_PLL clear
+ *
+ * Grid: mode x ewma_alpha x step threshold x pre-filter.
+ */
+
+static const int64_t NSEC_PER_MSEC = 1000000LL;
+
+struct sweep_point
+{
+    discipline_config config;
+    replay_result result;
+};
+
+static const char* mode_name(discipline_mode mode)
+{
+    return mode == discipline_mode::PI_LOOP ? "PI_LOOP" : "EWMA_SLEW";
+}
+
+static const char* prefilter_name(prefilter_mode mode)
+{
+    switch (mode)
+    {
+        case prefilter_mode::MEDIAN: return "median";
+        case prefilter_mode::HAMPEL: return "hampel";
+        case prefilter_mode::MIN_DELAY: return "min-delay";
+        case prefilter_mode::NONE:
+        default: return "none";
+    }
+}
+
+static std::vector<capture_record> synthetic_capture(double hours)
+{
+    const int jitter_ms[] = {0, 0, 0, 0, 15, -15, 20, -20, 10, -10};
+    const uint64_t start_ns = (uint64_t)clock_simulator::default_start_ns;
+    const size_t ticks = (size_t)(hours * 3600.0 * 10.0);
+
+    std::vector<capture_record> capture;
+    capture.reserve(ticks);
+    int64_t delay_ns = NSEC_PER_MSEC;
+    for (size_t i = 0; i < ticks; ++i)
+    {
+        delay_ns += jitter_ms[i % 10] * NSEC_PER_MSEC;
+        uint64_t source_ns = start_ns + i * 100 * NSEC_PER_MSEC;
+        capture.push_back(capture_record{source_ns, source_ns + (uint64_t)delay_ns});
+    }
+    return capture;
+}
+
+static std::vector<sweep_point> build_grid()
+{
+    const discipline_mode modes[] = {discipline_mode::EWMA_SLEW, discipline_mode::PI_LOOP};
+    const double alphas[] = {0.05, 0.1, 0.2, 0.3, 0.5};
+    const int64_t thresholds_ms[] = {1, 2, 3, 5, 10};
+    const prefilter_mode prefilters[] = {prefilter_mode::NONE, prefilter_mode::MEDIAN, prefilter_mode::MIN_DELAY};
+
+    std::vector<sweep_point> grid;
+    for (discipline_mode mode : modes)
+    {
+        for (double alpha : alphas)
+        {
+            for (int64_t threshold_ms : thresholds_ms)
+            {
+                for (prefilter_mode prefilter : prefilters)
+                {
+                    sweep_point point = {};
+                    point.config.mode = mode;
+                    point.config.ewma_alpha = alpha;
+                    point.config.step_threshold_ns = threshold_ms * NSEC_PER_MSEC;
+                    point.config.prefilter.mode = prefilter;
+                    grid.push_back(point);
+                }
+            }
+        }
+    }
+    return grid;
+}
+
+static void usage()
+{
+    fprintf(stderr, "Usage: clock_discipliner_sweep [--hours H] [--write-capture FILE] [--threads N] "
+                    "[--sort rms|max|steps] [--top N] [--frequency-ppb X] [--wander-ppb X] [--no-kernel-pll] [CAPTURE]\n");
+}
+
+int main(int argc, char* argv[])
+{
+    double hours = 6.0;
+    const char* capture_path = nullptr;
+    const char* write_path = nullptr;
+    const char* sort_key = "rms";
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t top = 20;
+
+    clock_model model;
+    model.initial_offset_ns = 2.0 * NSEC_PER_MSEC;
+    model.frequency_error_ppb = 10000.0;
+    model.wander_ppb = 1.0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--hours") == 0 && has_value)
+        {
+            hours = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--write-capture") == 0 && has_value)
+        {
+            write_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && has_value)
+        {
+            threads = std::max(1, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--sort") == 0 && has_value)
+        {
+            sort_key = argv[++i];
+        }
+        else if (strcmp(argv[i], "--top") == 0 && has_value)
+        {
+            top = (size_t)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--frequency-ppb") == 0 && has_value)
+        {
+            model.frequency_error_ppb = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--wander-ppb") == 0 && has_value)
+        {
+            model.wander_ppb = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--no-kernel-pll") == 0)
+        {
+            model.kernel_pll = false;
+        }
+        else if (argv[i][0] != '-')
+        {
+            capture_path = argv[i];
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    if (strcmp(sort_key, "rms") != 0 && strcmp(sort_key, "max") != 0 && strcmp(sort_key, "steps") != 0)
+    {
+        usage();
+        return 2;
+    }
+
+    std::vector<capture_record> capture;
+    if (capture_path != nullptr)
+    {
+        if (!load_capture(capture_path, capture))
+        {
+            fprintf(stderr, "%s: cannot read capture\n", capture_path);
+            return 1;
+        }
+    }
+    else
+    {
+        capture = synthetic_capture(hours);
+    }
+
+    if (write_path != nullptr)
+    {
+        capture_writer writer;
+        if (!writer.open(write_path))
+        {
+            perror(write_path);
+            return 1;
+        }
+        for (const capture_record& r : capture)
+        {
+            writer.append(r.source_ns, r.receive_ns);
+        }
+        writer.close();
+    }
+
+    if (capture.empty())
+    {
+        fprintf(stderr, "empty capture\n");
+        return 1;
+    }
+
+    /* Workers pull grid points off a shared counter; each replay owns its simulator */
+    std::vector<sweep_point> grid = build_grid();
+    std::atomic<size_t> next(0);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&]()
+        {
+            size_t i;
+            while ((i = next.fetch_add(1)) < grid.size())
+            {
+                grid[i].result = replay_capture(capture, model, grid[i].config);
+            }
+        });
+    }
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(grid.begin(), grid.end(), [sort_key](const sweep_point& a, const sweep_point& b)
+    {
+        if (strcmp(sort_key, "steps") == 0 && a.result.steps != b.result.steps)
+        {
+            return a.result.steps < b.result.steps;
+        }
+        if (strcmp(sort_key, "max") == 0 && a.result.max_abs_ns != b.result.max_abs_ns)
+        {
+            return a.result.max_abs_ns < b.result.max_abs_ns;
+        }
+        if (a.result.rms_ns != b.result.rms_ns)
+        {
+            return a.result.rms_ns < b.result.rms_ns;
+        }
+        return a.result.steps < b.result.steps;
+    });
+
+    double span_h = (double)(capture.back().source_ns - capture.front().source_ns) / 3.6e12;
+    printf("%zu configurations x %zu samples (%.1f h) on %u threads: %.2f s, %.0f simulated h/s\n", grid.size(),
+           capture.size(), span_h, threads, wall_s, span_h * grid.size() / wall_s);
+    printf("%4s  %-9s %5s %7s %-9s | %10s %10s %10s %6s\n", "rank", "mode", "alpha", "step", "prefilter", "mean ms",
+           "rms ms", "max ms", "steps");
+    for (size_t i = 0; i < grid.size() && i < top; ++i)
+    {
+        const sweep_point& p = grid[i];
+        printf("%4zu  %-9s %5.2f %4lld ms %-9s | %+10.3f %10.3f %10.3f %6llu\n", i + 1, mode_name(p.config.mode),
+               p.config.ewma_alpha, (long long)(p.config.step_threshold_ns / NSEC_PER_MSEC),
+               prefilter_name(p.config.prefilter.mode), p.result.mean_ns / 1e6, p.result.rms_ns / 1e6,
+               p.result.max_abs_ns / 1e6, (unsigned long long)p.result.steps);
+    }
+    return 0;
+}
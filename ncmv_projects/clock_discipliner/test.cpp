@@ -1,4 +1,6 @@
 #include "clock_discipliner.h"
+#include "discipline_thread.h"
+#include "sample_capture.h"
 
 #include <chrono>
 #include <thread>
@@ -6,9 +8,92 @@
 #include <iostream>
 #include <vector>
 
-int main()
+/*
+ * clock_discipliner_test [--threaded] [--trace FILE] [--stability FILE] [--capture FILE] [--publish NAME]
+ *
+ * --threaded: the tick loop only timestamps and queues samples; a
+ * discipline_thread applies them once per second
+ * --trace: record to a binary trace (see clock_trace_decode) instead of
+ * printing discipline messages
+ * --stability: write ADEV / TDEV / MTIE of the measured offsets as CSV
+ * --capture: record every (source, receive) sample for replay with
+ * clock_discipliner_sweep
+ * --publish: share the discipline state in POSIX shared memory NAME
+ * (e.g. /clock_discipliner) for clock_state_read and other readers
+ */
+int main(int argc, char* argv[])
 {
-    clock_discipliner discipliner;
+    bool threaded = false;
+    const char* trace_path = nullptr;
+    const char* stability_path = nullptr;
+    const char* capture_path = nullptr;
+    const char* publish_name = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--threaded") == 0)
+        {
+            threaded = true;
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            trace_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--stability") == 0 && i + 1 < argc)
+        {
+            stability_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+        {
+            capture_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--publish") == 0 && i + 1 < argc)
+        {
+            publish_name = argv[++i];
+        }
+    }
+
+    discipline_config config;
+    if (stability_path != nullptr)
+    {
+        config.stability.octaves = 12;
+    }
+    clock_discipliner discipliner(realtime_clock(), config);
+
+    trace_log trace;
+    if (trace_path != nullptr)
+    {
+        if (!trace.open(trace_path))
+        {
+            perror(trace_path);
+            return 1;
+        }
+        discipliner.set_trace(&trace);
+        discipliner.set_log(nullptr);
+    }
+    capture_writer capture;
+    if (capture_path != nullptr && !capture.open(capture_path))
+    {
+        perror(capture_path);
+        return 1;
+    }
+
+    shared_state_publisher publisher;
+    if (publish_name != nullptr)
+    {
+        if (!publisher.open(publish_name))
+        {
+            perror(publish_name);
+            return 1;
+        }
+        discipliner.set_publisher(&publisher);
+    }
+
+    discipline_thread<clock_discipliner> worker(discipliner);
+    if (threaded && !worker.start())
+    {
+        perror("discipline thread");
+        return 1;
+    }
     std::vector<int> jitter_ms = {0, 0, 0, 0, 15, -15, 20, -20, 10, -10 };
 
     uint64_t time_source_ms;
@@ -40,7 +125,34 @@ int main()
                i, jitter,
                (unsigned long long)time_source_ms);
 
-        discipliner.on_time_source_tick(time_source_ms);
+        struct timespec received;
+        clock_gettime(CLOCK_REALTIME, &received);
+        capture.append(time_source_ms * 1000000ULL, (uint64_t)received.tv_sec * 1000000000ULL + (uint64_t)received.tv_nsec);
+
+        if (threaded)
+        {
+            worker.submit(time_source_ms * 1000000ULL, received);
+        }
+        else
+        {
+            discipliner.on_time_source_tick(time_source_ms);
+        }
+    }
+
+    worker.stop();
+    trace.close();
+    capture.close();
+
+    if (stability_path != nullptr)
+    {
+        FILE* csv = fopen(stability_path, "w");
+        if (csv == nullptr)
+        {
+            perror(stability_path);
+            return 1;
+        }
+        discipliner.stability().write_csv(csv);
+        fclose(csv);
     }
 
     printf("Test completed.\n");
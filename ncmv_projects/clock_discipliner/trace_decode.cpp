@@ -0,0 +1,141 @@
+#include "trace_log.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Renders a binary trace_log file.
+ *
+ *   clock_trace_decode [--csv] FILE
+ *
+ * Text output shows times relative to the first record; CSV output keeps
+ * the raw CLOCK_MONOTONIC nanoseconds and integer fields.
+ */
+
+static const char* event_name(uint16_t event)
+{
+    switch (event)
+    {
+        case TRACE_SAMPLE: return "sample";
+        case TRACE_FILTERED: return "filtered";
+        case TRACE_STEP: return "step";
+        case TRACE_SLEW: return "slew";
+        case TRACE_STEER: return "steer";
+        case TRACE_HOLDOVER: return "holdover";
+        case TRACE_REACQUIRE: return "reacquire";
+        default: return "unknown";
+    }
+}
+
+static void print_text(const trace_record& r, uint64_t first_ns)
+{
+    printf("%12.6f t%-2u %-8s ", (r.time_ns - first_ns) / 1e9, (unsigned)r.thread, event_name(r.event));
+
+    switch (r.event)
+    {
+        case TRACE_SAMPLE:
+            printf("offset %+.6f ms, filtered %+.6f ms", r.value1 / 1e6, r.value2 / 1e6);
+            break;
+        case TRACE_FILTERED:
+            printf("offset %+.6f ms", r.value1 / 1e6);
+            break;
+        case TRACE_STEP:
+            printf("by %+.6f ms, offset %+.6f ms, syscall %.3f us", r.value1 / 1e6, r.value2 / 1e6, r.latency_ns / 1e3);
+            break;
+        case TRACE_SLEW:
+            printf("by %+.6f ms, syscall %.3f us", r.value1 / 1e6, r.latency_ns / 1e3);
+            break;
+        case TRACE_STEER:
+            printf("offset %+.6f ms, frequency %+.3f ppm, syscall %.3f us", r.value1 / 1e6, r.value2 / 1e9, r.latency_ns / 1e3);
+            break;
+        case TRACE_HOLDOVER:
+            printf("offset %+.6f ms, %.3f s since last sample", r.value1 / 1e6, r.value2 / 1e3);
+            break;
+        case TRACE_REACQUIRE:
+            printf("offset %+.6f ms, predicted error %.6f ms", r.value1 / 1e6, r.value2 / 1e6);
+            break;
+        default:
+            printf("%lld %lld", (long long)r.value1, (long long)r.value2);
+            break;
+    }
+
+    if (r.error != 0)
+    {
+        printf(" [%s]", strerror(r.error));
+    }
+    printf("\n");
+}
+
+static void print_csv(const trace_record& r)
+{
+    printf("%llu,%u,%s,%lld,%lld,%lld,%d\n", (unsigned long long)r.time_ns, (unsigned)r.thread, event_name(r.event),
+           (long long)r.value1, (long long)r.value2, (long long)r.latency_ns, r.error);
+}
+
+int main(int argc, char* argv[])
+{
+    bool csv = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--csv") == 0)
+        {
+            csv = true;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+
+    if (path == nullptr)
+    {
+        fprintf(stderr, "Usage: clock_trace_decode [--csv] FILE\n");
+        return 2;
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        perror(path);
+        return 1;
+    }
+
+    trace_file_header header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, "CDTRACE1", sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(trace_record))
+    {
+        fprintf(stderr, "%s: not a clock discipliner trace\n", path);
+        fclose(file);
+        return 1;
+    }
+
+    if (csv)
+    {
+        printf("time_ns,thread,event,value1,value2,latency_ns,error\n");
+    }
+
+    trace_record record;
+    uint64_t first_ns = 0;
+    bool first = true;
+    while (fread(&record, sizeof(record), 1, file) == 1)
+    {
+        if (first)
+        {
+            first_ns = record.time_ns;
+            first = false;
+        }
+
+        if (csv)
+        {
+            print_csv(record);
+        }
+        else
+        {
+            print_text(record, first_ns);
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,334 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TRACE_LOG_H
+#define TRACE_LOG_H
+
+#pragma once
+
+#include "spsc_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Binary trace log
+ *
+ * - Each writing thread gets its own SPSC ring of fixed-size records;
+ *   record() is wait-free once the thread's ring exists (the first
+ *   record() on a thread takes a lock to create it)
+ * - A background thread drains every ring into the file every
+ *   flush_interval_ms, so the discipline path never blocks on I/O
+ * - A full ring drops the record and counts it
+ *
+ * File layout: trace_file_header, then trace_record after trace_record,
+ * native byte order. clock_trace_decode renders it as text or CSV.
+ */
+
+enum trace_event : uint16_t
+{
+    TRACE_SAMPLE = 1,   /* value1: raw offset ns, value2: pre-filtered offset ns */
+    TRACE_FILTERED = 2, /* value1: EWMA offset ns at a discipline decision */
+    TRACE_STEP = 3,     /* value1: step applied ns, value2: filtered offset ns; latency and error of the syscall */
+    TRACE_SLEW = 4,     /* value1: ADJ_OFFSET ns; latency and error of the syscall */
+    TRACE_STEER = 5,    /* value1: ADJ_OFFSET ns, value2: frequency in 1e-3 ppb; latency, error */
+    TRACE_HOLDOVER = 6, /* value1: offset ns at loss, value2: ms since the last sample; latency, error */
+    TRACE_REACQUIRE = 7 /* value1: first offset ns after holdover, value2: predicted error ns */
+};
+
+struct trace_record
+{
+    uint64_t time_ns;   /* CLOCK_MONOTONIC when recorded */
+    uint16_t event;     /* trace_event */
+    uint16_t thread;    /* writer index within this log */
+    int32_t error;      /* errno of a failed syscall, else 0 */
+    int64_t value1;
+    int64_t value2;
+    int64_t latency_ns; /* duration of the clock syscall, if any */
+};
+
+static_assert(sizeof(trace_record) == 40, "trace_record is a file format");
+
+struct trace_file_header
+{
+    char magic[8];        /* "CDTRACE1" */
+    uint32_t record_size; /* sizeof(trace_record) */
+    uint32_t reserved;
+};
+
+class trace_log
+{
+public:
+    static const size_t ring_records = 4096;
+
+    trace_log()
+        : id(next_log_id()),
+          fd(-1),
+          active(false),
+          stopping(false)
+    {}
+
+    ~trace_log()
+    {
+        close();
+    }
+
+    trace_log(const trace_log&) = delete;
+    trace_log& operator=(const trace_log&) = delete;
+
+    /* Create (truncate) path, write the header and start the writer thread */
+    bool open(const char* path, int64_t flush_interval_ms = 50)
+    {
+        if (active.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        trace_file_header header;
+        memcpy(header.magic, "CDTRACE1", sizeof(header.magic));
+        header.record_size = sizeof(trace_record);
+        header.reserved = 0;
+        if (!write_all(&header, sizeof(header)))
+        {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+
+        stopping = false;
+        active.store(true, std::memory_order_release);
+        writer = std::thread([this, flush_interval_ms]() { run(flush_interval_ms); });
+        return true;
+    }
+
+    /* Flush everything recorded so far and close the file */
+    void close()
+    {
+        if (!writer.joinable())
+        {
+            return;
+        }
+
+        active.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+
+        ::close(fd);
+        fd = -1;
+    }
+
+    bool is_open() const { return active.load(std::memory_order_acquire); }
+
+    void record(trace_event event, int64_t value1, int64_t value2 = 0, int64_t latency_ns = 0, int32_t error = 0)
+    {
+        if (!active.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        thread_buffer* buffer = local_buffer();
+        trace_record r;
+        r.time_ns = monotonic_ns();
+        r.event = event;
+        r.thread = buffer->index;
+        r.error = error;
+        r.value1 = value1;
+        r.value2 = value2;
+        r.latency_ns = latency_ns;
+
+        if (!buffer->ring.try_push(r))
+        {
+            buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+
+    /* Records lost to full rings, over all threads */
+    uint64_t dropped() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uint64_t total = 0;
+        for (const std::unique_ptr<thread_buffer>& buffer : buffers)
+        {
+            total += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    static uint64_t monotonic_ns()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    }
+
+private:
+    struct thread_buffer
+    {
+        std::thread::id owner;
+        uint16_t index;
+        std::atomic<uint64_t> dropped;
+        spsc_ring<trace_record, ring_records> ring;
+
+        thread_buffer(std::thread::id thread, uint16_t position)
+            : owner(thread),
+              index(position),
+              dropped(0)
+        {}
+    };
+
+    /* Per-thread cache of the last log written to, keyed by log id */
+    struct thread_slot
+    {
+        uint64_t log_id;
+        thread_buffer* buffer;
+    };
+
+    const uint64_t id;
+    int fd;
+    std::atomic<bool> active;
+    std::thread writer;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::vector<std::unique_ptr<thread_buffer>> buffers;
+
+    static uint64_t next_log_id()
+    {
+        static std::atomic<uint64_t> counter(0);
+        return ++counter;
+    }
+
+    thread_buffer* local_buffer()
+    {
+        thread_local thread_slot slot = {0, nullptr};
+        if (slot.log_id == id)
+        {
+            return slot.buffer;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::thread::id self = std::this_thread::get_id();
+        thread_buffer* found = nullptr;
+        for (const std::unique_ptr<thread_buffer>& buffer : buffers)
+        {
+            if (buffer->owner == self)
+            {
+                found = buffer.get();
+                break;
+            }
+        }
+        if (found == nullptr)
+        {
+            buffers.emplace_back(new thread_buffer(self, (uint16_t)buffers.size()));
+            found = buffers.back().get();
+        }
+
+        slot.log_id = id;
+        slot.buffer = found;
+        return found;
+    }
+
+    bool write_all(const void* data, size_t size)
+    {
+        const char* p = static_cast<const char*>(data);
+        while (size > 0)
+        {
+            ssize_t n = ::write(fd, p, size);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            p += n;
+            size -= (size_t)n;
+        }
+        return true;
+    }
+
+    void run(int64_t flush_interval_ms)
+    {
+        std::vector<trace_record> pending;
+        std::vector<thread_buffer*> snapshot;
+        bool last = false;
+
+        while (!last)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait_for(lock, std::chrono::milliseconds(flush_interval_ms), [this]() { return stopping; });
+                last = stopping;
+
+                snapshot.clear();
+                for (const std::unique_ptr<thread_buffer>& buffer : buffers)
+                {
+                    snapshot.push_back(buffer.get());
+                }
+            }
+
+            pending.clear();
+            for (thread_buffer* buffer : snapshot)
+            {
+                trace_record batch[256];
+                size_t count;
+                while ((count = buffer->ring.pop_batch(batch, 256)) > 0)
+                {
+                    pending.insert(pending.end(), batch, batch + count);
+                }
+            }
+
+            if (!pending.empty())
+            {
+                write_all(pending.data(), pending.size() * sizeof(trace_record));
+            }
+        }
+    }
+};
+
+#endif // TRACE_LOG_H
@@ -0,0 +1,325 @@
+/**
+MIT License
+
+Copyright (c) 2025 nguyenchiemminhvu@gmail.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TSC_CLOCK_H
+#define TSC_CLOCK_H
+
+#pragma once
+
+#include "clock_backend.h"
+
+#include <stdint.h>
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define TSC_CLOCK_HAVE_RDTSC 1
+#else
+#define TSC_CLOCK_HAVE_RDTSC 0
+#endif
+
+/*
+ * Cheap realtime timestamps from the TSC
+ *
+ * fast_now_ns() = base_ns + (counter - base_counter) * scale, with the
+ * three parameters published under a seqlock: one rdtsc, a few loads and
+ * a 128-bit multiply, no syscall and no vDSO call.
+ *
+ * calibrate() pairs a counter reading with the reference clock
+ * (CLOCK_REALTIME by default, so it follows the discipliner's slews):
+ * - the rate comes from the reference interval since the last pair
+ * - the line is re-anchored where the old one predicted "now", so
+ *   fast_now_ns() never jumps, and its slope is bent to cancel the
+ *   measured error over the next interval
+ * - an error above step_limit_ns (the reference was stepped) re-anchors
+ *   on the reference directly
+ * start() runs calibrate() on a background thread.
+ *
+ * max_error_ns() is the largest error measured at a calibration plus the
+ * pairing uncertainty. Without an invariant TSC (or off x86) the counter
+ * is CLOCK_MONOTONIC_RAW, which is correct but no faster.
+ */
+
+class tsc_clock
+{
+public:
+    static constexpr int64_t step_limit_ns = 1000000; /* 1 ms */
+
+    explicit tsc_clock(clock_backend& clock = default_clock_backend())
+        : reference(clock),
+          use_tsc(tsc_is_invariant()),
+          sequence(0),
+          base_counter(0),
+          base_ns(0),
+          scale(0),
+          calibrated(false),
+          anchor_counter(0),
+          anchor_ns(0),
+          last_error(0),
+          worst_error(0),
+          stopping(false)
+    {}
+
+    ~tsc_clock()
+    {
+        stop();
+    }
+
+    tsc_clock(const tsc_clock&) = delete;
+    tsc_clock& operator=(const tsc_clock&) = delete;
+
+    /* x86 invariant TSC: CPUID 0x80000007, EDX bit 8 */
+    static bool tsc_is_invariant()
+    {
+#if TSC_CLOCK_HAVE_RDTSC
+        unsigned int eax, ebx, ecx, edx;
+        return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    bool uses_tsc() const { return use_tsc; }
+
+    /* Nanoseconds since the epoch; 0 before the first calibrate() */
+    uint64_t fast_now_ns() const
+    {
+        for (;;)
+        {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                continue;
+            }
+
+            uint64_t counter0 = base_counter.load(std::memory_order_relaxed);
+            uint64_t ns0 = base_ns.load(std::memory_order_relaxed);
+            uint64_t mult = scale.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) != before)
+            {
+                continue;
+            }
+
+            int64_t ticks = (int64_t)(read_counter() - counter0);
+            return ns0 + (uint64_t)(((wide_int)ticks * (wide_int)mult) >> SCALE_SHIFT);
+        }
+    }
+
+    /*
+     * Pair the counter with the reference clock and update the published
+     * line. The first call takes two pairs 10 ms apart to get a rate.
+     * Calls must not overlap (start() or one caller thread).
+     */
+    void calibrate()
+    {
+        uint64_t counter = 0;
+        uint64_t ns = 0;
+        uint64_t width = 0;
+        take_pair(counter, ns, width);
+
+        if (!calibrated)
+        {
+            anchor_counter = counter;
+            anchor_ns = ns;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            take_pair(counter, ns, width);
+
+            publish(counter, ns, rate_scale(counter, ns));
+            anchor_counter = counter;
+            anchor_ns = ns;
+            calibrated = true;
+            return;
+        }
+
+        uint64_t mult = rate_scale(counter, ns);
+        int64_t interval_ns = (int64_t)(ns - anchor_ns);
+        int64_t predicted = (int64_t)predict(counter);
+        int64_t error = predicted - (int64_t)ns;
+        int64_t uncertainty = (int64_t)(((wide_int)width * (wide_int)mult) >> SCALE_SHIFT) / 2;
+
+        if (error > step_limit_ns || error < -step_limit_ns || interval_ns <= 0)
+        {
+            publish(counter, ns, mult);
+        }
+        else
+        {
+            /* Continue from the predicted point; absorb the error over one more interval */
+            double bend = 1.0 - (double)error / (double)interval_ns;
+            publish(counter, (uint64_t)predicted, (uint64_t)((double)mult * bend));
+
+            int64_t magnitude = (error < 0 ? -error : error) + uncertainty;
+            if (magnitude > worst_error.load(std::memory_order_relaxed))
+            {
+                worst_error.store(magnitude, std::memory_order_relaxed);
+            }
+        }
+
+        last_error.store(error, std::memory_order_relaxed);
+        anchor_counter = counter;
+        anchor_ns = ns;
+    }
+
+    /* Calibrate now and then every interval_ms on a background thread */
+    void start(int64_t interval_ms = 1000)
+    {
+        if (worker.joinable())
+        {
+            return;
+        }
+
+        calibrate();
+        stopping = false;
+        worker = std::thread([this, interval_ms]()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!wake.wait_for(lock, std::chrono::milliseconds(interval_ms), [this]() { return stopping; }))
+            {
+                calibrate();
+            }
+        });
+    }
+
+    void stop()
+    {
+        if (!worker.joinable())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    /* fast_now_ns() minus the reference at the last calibration */
+    int64_t last_error_ns() const { return last_error.load(std::memory_order_relaxed); }
+
+    /* Largest |error| measured at any calibration after the first, plus pairing uncertainty */
+    int64_t max_error_ns() const { return worst_error.load(std::memory_order_relaxed); }
+
+private:
+    __extension__ typedef __int128 wide_int;
+    __extension__ typedef unsigned __int128 wide_uint;
+
+    static constexpr int SCALE_SHIFT = 32; /* scale is ns per count in 32.32 fixed point */
+
+    clock_backend& reference;
+    const bool use_tsc;
+
+    /* Published line, guarded by sequence; one writer */
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint64_t> base_counter;
+    std::atomic<uint64_t> base_ns;
+    std::atomic<uint64_t> scale;
+
+    /* Calibration state, calibrating thread only */
+    bool calibrated;
+    uint64_t anchor_counter;
+    uint64_t anchor_ns;
+
+    std::atomic<int64_t> last_error;
+    std::atomic<int64_t> worst_error;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+
+    uint64_t read_counter() const
+    {
+#if TSC_CLOCK_HAVE_RDTSC
+        if (use_tsc)
+        {
+            return __rdtsc();
+        }
+#endif
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    }
+
+    /* Tightest of a few (counter, reference) pairs; counter is the midpoint */
+    void take_pair(uint64_t& counter, uint64_t& ns, uint64_t& width)
+    {
+        width = UINT64_MAX;
+        for (int attempt = 0; attempt < 5; ++attempt)
+        {
+            struct timespec ts;
+            uint64_t before = read_counter();
+            reference.gettime(&ts);
+            uint64_t after = read_counter();
+
+            if (after - before < width)
+            {
+                width = after - before;
+                counter = before + width / 2;
+                ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+            }
+        }
+    }
+
+    uint64_t rate_scale(uint64_t counter, uint64_t ns) const
+    {
+        uint64_t ticks = counter - anchor_counter;
+        if (ticks == 0)
+        {
+            return scale.load(std::memory_order_relaxed);
+        }
+        return (uint64_t)(((wide_uint)(ns - anchor_ns) << SCALE_SHIFT) / ticks);
+    }
+
+    uint64_t predict(uint64_t counter) const
+    {
+        int64_t ticks = (int64_t)(counter - base_counter.load(std::memory_order_relaxed));
+        return base_ns.load(std::memory_order_relaxed) +
+               (uint64_t)(((wide_int)ticks * (wide_int)scale.load(std::memory_order_relaxed)) >> SCALE_SHIFT);
+    }
+
+    void publish(uint64_t counter, uint64_t ns, uint64_t mult)
+    {
+        uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        base_counter.store(counter, std::memory_order_relaxed);
+        base_ns.store(ns, std::memory_order_relaxed);
+        scale.store(mult, std::memory_order_relaxed);
+
+        sequence.store(s + 2, std::memory_order_release);
+    }
+};
+
+#endif // TSC_CLOCK_H
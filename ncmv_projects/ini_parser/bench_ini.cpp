@@ -0,0 +1,439 @@
+#include "ini_parser.h"
+#include "ini_batch_io.h"
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cstdlib>
+
+#include <malloc.h>
+#include <unistd.h>
+
+namespace
+{
+    typedef std::chrono::steady_clock bench_clock;
+
+    double elapsed_ms(bench_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+    }
+
+    // Tenant overrides: `shared` keys common to all parsers, the rest private to each tenant
+    std::vector<ini_parser::ini_parser> make_tenants(size_t count, size_t keys_per_tenant, size_t shared)
+    {
+        std::vector<ini_parser::ini_parser> tenants(count);
+        for (size_t t = 0; t < count; ++t)
+        {
+            for (size_t k = 0; k < keys_per_tenant; ++k)
+            {
+                std::string key = k < shared
+                    ? "Common" + std::to_string(k % 32) + ".key" + std::to_string(k)
+                    : "Tenant" + std::to_string(t) + ".key" + std::to_string(k);
+                tenants[t].set(key, "value_for_tenant_" + std::to_string(t) + "_" + std::to_string(k));
+            }
+        }
+        return tenants;
+    }
+
+    void bench_merge(size_t count, size_t keys_per_tenant, size_t shared, ini_parser::merge_strategy strategy)
+    {
+        std::vector<ini_parser::ini_parser> tenants = make_tenants(count, keys_per_tenant, shared);
+        std::vector<const ini_parser::base_ini_parser*> views;
+        for (const auto& tenant : tenants)
+            views.push_back(&tenant);
+
+        ini_parser::ini_parser repeated;
+        bench_clock::time_point start = bench_clock::now();
+        for (const auto& tenant : tenants)
+            repeated.merge(tenant, strategy);
+        double repeated_ms = elapsed_ms(start);
+
+        ini_parser::ini_parser folded;
+        start = bench_clock::now();
+        folded.merge_all(views, strategy);
+        double folded_ms = elapsed_ms(start);
+
+        bool same = repeated.size() == folded.size();
+        for (auto a = repeated.begin(), b = folded.begin(); same && a != repeated.end(); ++a, ++b)
+            same = a->first == b->first && a->second == b->second;
+
+        std::cout << "merge " << count << " x " << keys_per_tenant << " keys, " << shared << " shared ("
+                  << (strategy == ini_parser::merge_strategy::OVERWRITE ? "OVERWRITE" : "PRESERVE") << "): "
+                  << "merge() " << repeated_ms << " ms, merge_all() " << folded_ms << " ms"
+                  << (same ? "" : " [MISMATCH]") << std::endl;
+    }
+
+    // Validation pipeline: many small documents, a share of them malformed
+    void bench_error_heavy(size_t documents, size_t malformed_percent)
+    {
+        std::vector<std::string> inputs;
+        inputs.reserve(documents);
+        for (size_t d = 0; d < documents; ++d)
+        {
+            std::string text = "[Service]\nname = svc" + std::to_string(d) + "\nport = 80" + std::to_string(d % 10) + "\n";
+            if (d % 100 < malformed_percent)
+                text += "this line has no separator\n";
+            inputs.push_back(text);
+        }
+
+        ini_parser::ini_parser parser;
+        size_t throwing_failures = 0;
+        bench_clock::time_point start = bench_clock::now();
+        for (const std::string& text : inputs)
+        {
+            try
+            {
+                parser.load_from_buffer(text);
+            }
+            catch (const ini_parser::parse_error&)
+            {
+                ++throwing_failures;
+            }
+        }
+        double throwing_ms = elapsed_ms(start);
+
+        size_t expected_failures = 0;
+        start = bench_clock::now();
+        for (const std::string& text : inputs)
+        {
+            if (!parser.try_load_from_buffer(text))
+                ++expected_failures;
+        }
+        double expected_ms = elapsed_ms(start);
+
+        std::cout << "validate " << documents << " documents, " << malformed_percent << "% malformed: "
+                  << "load_from_buffer() " << throwing_ms << " ms, try_load_from_buffer() " << expected_ms << " ms"
+                  << (throwing_failures == expected_failures ? "" : " [MISMATCH]") << std::endl;
+    }
+
+    // Dashboard export: whole-parser JSON round trip, reported in MB/s of JSON text
+    void bench_json(size_t keys)
+    {
+        ini_parser::ini_parser parser;
+        for (size_t k = 0; k < keys; ++k)
+        {
+            std::string key = "Section" + std::to_string(k % 64) + ".key" + std::to_string(k);
+            switch (k % 4)
+            {
+                case 0: parser.set(key, static_cast<int>(k)); break;
+                case 1: parser.set(key, k * 0.25); break;
+                case 2: parser.set(key, "plain value for dashboards number " + std::to_string(k)); break;
+                default: parser.set(key, "needs \"escaping\"\tand\\more " + std::to_string(k)); break;
+            }
+        }
+
+        const int rounds = 10;
+
+        // Baseline: walk begin()/end() and format through a stream
+        bench_clock::time_point start = bench_clock::now();
+        size_t stream_bytes = 0;
+        for (int r = 0; r < rounds; ++r)
+        {
+            std::ostringstream out;
+            out << '{';
+            bool first = true;
+            for (const auto& pair : parser)
+            {
+                out << (first ? "" : ",") << '"' << pair.first << "\":";
+                if (pair.second.is_string())
+                {
+                    out << '"';
+                    for (char c : pair.second.as_string())
+                    {
+                        if (c == '"' || c == '\\')
+                            out << '\\' << c;
+                        else if (c == '\t')
+                            out << "\\t";
+                        else
+                            out << c;
+                    }
+                    out << '"';
+                }
+                else if (pair.second.is_double())
+                    out << pair.second.as_double();
+                else
+                    out << pair.second.as_int();
+                first = false;
+            }
+            out << '}';
+            stream_bytes += out.str().size();
+        }
+        double stream_ms = elapsed_ms(start);
+
+        std::string buffer;
+        size_t json_bytes = 0;
+        start = bench_clock::now();
+        for (int r = 0; r < rounds; ++r)
+        {
+            buffer.clear();
+            parser.to_json(buffer);
+            json_bytes += buffer.size();
+        }
+        double export_ms = elapsed_ms(start);
+
+        ini_parser::ini_parser imported;
+        start = bench_clock::now();
+        for (int r = 0; r < rounds; ++r)
+            imported.from_json(buffer);
+        double import_ms = elapsed_ms(start);
+
+        bool same = imported.size() == parser.size();
+        for (auto a = parser.begin(), b = imported.begin(); same && a != parser.end(); ++a, ++b)
+            same = a->first == b->first && a->second == b->second;
+
+        auto mb_per_s = [](size_t bytes, double ms) { return bytes / (1024.0 * 1024.0) / (ms / 1000.0); };
+        std::cout << "json " << keys << " keys: stream export " << mb_per_s(stream_bytes, stream_ms) << " MB/s, "
+                  << "to_json " << mb_per_s(json_bytes, export_ms) << " MB/s, "
+                  << "from_json " << mb_per_s(json_bytes, import_ms) << " MB/s"
+                  << (same ? "" : " [MISMATCH]") << std::endl;
+    }
+
+    // Resident set size from /proc/self/statm, in MB
+    double resident_mb()
+    {
+        std::ifstream statm("/proc/self/statm");
+        size_t total_pages = 0;
+        size_t resident_pages = 0;
+        statm >> total_pages >> resident_pages;
+        return resident_pages * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+    }
+
+    // Live heap in MB. Freed blocks stay in the allocator's pools, so RSS would also
+    // count memory that earlier benchmarks released; glibc can report what is in use.
+    double heap_in_use_mb()
+    {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        return mallinfo2().uordblks / (1024.0 * 1024.0);
+#else
+        return resident_mb();
+#endif
+    }
+
+    // RSS after handing free allocator pages back to the kernel, so pools that earlier
+    // benchmarks released are not counted
+    double trimmed_resident_mb()
+    {
+#if defined(__GLIBC__)
+        malloc_trim(0);
+#endif
+        return resident_mb();
+    }
+
+    // Baseline for bench_reassign: config_value as it was before assignment released
+    // the previous alternative. Same members; copy and move only write the member of
+    // the incoming type, so the others keep whatever they held.
+    class stale_member_value
+    {
+    public:
+        stale_member_value() : type_(ini_parser::config_value::value_type::TYPE_NULL), int_value_(0) {}
+        stale_member_value(int value) : type_(ini_parser::config_value::value_type::TYPE_INT), int_value_(value) {}
+        stale_member_value(const char* value) : type_(ini_parser::config_value::value_type::TYPE_STRING), int_value_(0), string_value_(value) {}
+        stale_member_value(const std::string& value) : type_(ini_parser::config_value::value_type::TYPE_STRING), int_value_(0), string_value_(value) {}
+        stale_member_value(const std::vector<stale_member_value>& value)
+            : type_(ini_parser::config_value::value_type::TYPE_ARRAY), int_value_(0), array_value_(value) {}
+        stale_member_value(const std::map<std::string, stale_member_value>& value)
+            : type_(ini_parser::config_value::value_type::TYPE_OBJECT), int_value_(0), object_value_(value) {}
+
+        stale_member_value(const stale_member_value& other) = default;
+        stale_member_value(stale_member_value&& other) = default;
+
+        stale_member_value& operator=(const stale_member_value& other)
+        {
+            if (this != &other)
+            {
+                type_ = other.type_;
+                switch (type_)
+                {
+                    case ini_parser::config_value::value_type::TYPE_STRING: string_value_ = other.string_value_; break;
+                    case ini_parser::config_value::value_type::TYPE_ARRAY: array_value_ = other.array_value_; break;
+                    case ini_parser::config_value::value_type::TYPE_OBJECT: object_value_ = other.object_value_; break;
+                    default: int_value_ = other.int_value_; break;
+                }
+            }
+            return *this;
+        }
+
+        stale_member_value& operator=(stale_member_value&& other) noexcept
+        {
+            if (this != &other)
+            {
+                type_ = other.type_;
+                switch (type_)
+                {
+                    case ini_parser::config_value::value_type::TYPE_STRING: string_value_ = std::move(other.string_value_); break;
+                    case ini_parser::config_value::value_type::TYPE_ARRAY: array_value_ = std::move(other.array_value_); break;
+                    case ini_parser::config_value::value_type::TYPE_OBJECT: object_value_ = std::move(other.object_value_); break;
+                    default: int_value_ = other.int_value_; break;
+                }
+            }
+            return *this;
+        }
+
+    private:
+        ini_parser::config_value::value_type type_;
+        int64_t int_value_;
+        std::string string_value_;
+        std::vector<stale_member_value> array_value_;
+        std::map<std::string, stale_member_value> object_value_;
+    };
+
+    // Long-running reassignment: values cycle object -> string -> array -> moved-from.
+    // Growth is reported both as live heap and as trimmed RSS, less the slots themselves.
+    template<typename Value>
+    void bench_reassign(const char* name, size_t slots, size_t assignments)
+    {
+        std::map<std::string, Value> object;
+        for (int i = 0; i < 16; ++i)
+            object["member" + std::to_string(i)] = Value("payload string that does not fit SSO " + std::to_string(i));
+        const Value object_value(object);
+        const Value string_value("short");
+        const Value array_value(std::vector<Value>(32, Value(1)));
+
+        double before_heap_mb = heap_in_use_mb();
+        double before_rss_mb = trimmed_resident_mb();
+        std::vector<Value> values(slots);
+        Value sink;
+
+        bench_clock::time_point start = bench_clock::now();
+        for (size_t n = 0; n < assignments; ++n)
+        {
+            Value& slot = values[n % slots];
+            switch ((n / slots) % 4)
+            {
+                case 0: slot = object_value; break;
+                case 1: slot = string_value; break;
+                case 2: slot = array_value; break;
+                default: sink = std::move(slot); break;
+            }
+        }
+        double reassign_ms = elapsed_ms(start);
+
+        const double slots_mb = slots * sizeof(Value) / (1024.0 * 1024.0);
+        std::cout << "reassign " << assignments << " times over " << slots << " values, " << name << ": " << reassign_ms
+                  << " ms, retained beyond the " << slots_mb << " MB of slots: heap " << (heap_in_use_mb() - before_heap_mb - slots_mb)
+                  << " MB, RSS " << (trimmed_resident_mb() - before_rss_mb - slots_mb) << " MB" << std::endl;
+    }
+
+    // Tenant cleanup: load many keys, remove most of them, then compact
+    void bench_compact(size_t keys, size_t keep_every)
+    {
+        ini_parser::ini_parser parser;
+        for (size_t k = 0; k < keys; ++k)
+            parser.set("Tenant" + std::to_string(k % 1000) + ".setting_" + std::to_string(k), "value that lives on the heap " + std::to_string(k));
+        double loaded_mb = resident_mb();
+
+        std::vector<std::string> doomed;
+        for (const auto& pair : parser)
+        {
+            if (std::hash<std::string>()(pair.first) % keep_every != 0)
+                doomed.push_back(pair.first);
+        }
+        for (const std::string& key : doomed)
+            parser.remove(key);
+        std::vector<std::string>().swap(doomed);
+        double removed_mb = resident_mb();
+
+        bench_clock::time_point start = bench_clock::now();
+        ini_parser::ini_parser::compaction_result reclaimed = parser.compact();
+        double compact_ms = elapsed_ms(start);
+
+        std::cout << "compact " << keys << " keys, kept " << parser.size() << ": RSS loaded " << loaded_mb
+                  << " MB, after remove " << removed_mb << " MB, after compact " << resident_mb() << " MB (reported "
+                  << reclaimed.resident_bytes_reclaimed / (1024 * 1024) << " MB, " << compact_ms << " ms)" << std::endl;
+    }
+
+    // Save and reload many small config files: one syscall per file operation with
+    // ofstream/ifstream, or a few io_uring_enter calls per batch with batch_io
+    void bench_batch_io(size_t files)
+    {
+        char dir_template[] = "/tmp/bench_ini_XXXXXX";
+        if (::mkdtemp(dir_template) == nullptr)
+        {
+            std::cout << "batch io: cannot create a temporary directory" << std::endl;
+            return;
+        }
+        const std::string dir = dir_template;
+
+        std::vector<ini_parser::ini_parser> parsers(files);
+        std::vector<const ini_parser::ini_parser*> sources;
+        std::vector<std::string> paths;
+        for (size_t f = 0; f < files; ++f)
+        {
+            for (size_t k = 0; k < 20; ++k)
+                parsers[f].set("Service" + std::to_string(k % 4) + ".option" + std::to_string(k), "value " + std::to_string(f * k));
+            sources.push_back(&parsers[f]);
+            paths.push_back(dir + "/service" + std::to_string(f) + ".ini");
+        }
+
+        bench_clock::time_point start = bench_clock::now();
+        for (size_t f = 0; f < files; ++f)
+            parsers[f].save(paths[f]);
+        double stream_save_ms = elapsed_ms(start);
+
+        start = bench_clock::now();
+        for (size_t f = 0; f < files; ++f)
+        {
+            ini_parser::ini_parser loaded;
+            loaded.load(paths[f]);
+        }
+        double stream_load_ms = elapsed_ms(start);
+        std::cout << "batch io " << files << " files, per-file save()/load(): save " << stream_save_ms
+                  << " ms, load " << stream_load_ms << " ms" << std::endl;
+
+        for (ini_parser::batch_io::backend mode : {ini_parser::batch_io::backend::BLOCKING, ini_parser::batch_io::backend::AUTO})
+        {
+            ini_parser::batch_io io(mode);
+            const char* name = io.uses_io_uring() ? "io_uring" : "blocking";
+            bool ok = true;
+
+            for (bool sync : {false, true})
+            {
+                size_t before = io.syscall_count();
+                start = bench_clock::now();
+                for (const auto& saved : ini_parser::save_files(io, paths, sources, sync))
+                    ok = ok && saved.has_value();
+                double save_ms = elapsed_ms(start);
+                std::cout << "batch io " << files << " files, " << name << (sync ? " save+fsync " : " save ") << save_ms
+                          << " ms, " << double(io.syscall_count() - before) / files << " syscalls/file" << std::endl;
+            }
+
+            std::vector<ini_parser::ini_parser> loaded;
+            size_t before = io.syscall_count();
+            start = bench_clock::now();
+            for (const auto& result : ini_parser::load_files(io, paths, loaded))
+                ok = ok && result.has_value();
+            double load_ms = elapsed_ms(start);
+            ok = ok && loaded.back().get_keys() == parsers.back().get_keys();
+            std::cout << "batch io " << files << " files, " << name << " load " << load_ms << " ms, "
+                      << double(io.syscall_count() - before) / files << " syscalls/file" << (ok ? "" : " [FAILED]") << std::endl;
+        }
+
+        for (const std::string& path : paths)
+            ::unlink(path.c_str());
+        ::rmdir(dir.c_str());
+    }
+}
+
+int main()
+{
+    // First, so RSS is not inflated by pools left over from the other benchmarks
+    bench_compact(1000000, 10);
+    bench_merge(100, 1000, 1000, ini_parser::merge_strategy::OVERWRITE);
+    bench_merge(100, 1000, 1000, ini_parser::merge_strategy::PRESERVE);
+    bench_merge(500, 2000, 100, ini_parser::merge_strategy::OVERWRITE);
+    bench_merge(500, 2000, 100, ini_parser::merge_strategy::PRESERVE);
+    bench_error_heavy(200000, 0);
+    bench_error_heavy(200000, 50);
+    bench_error_heavy(200000, 100);
+    bench_json(200000);
+    bench_reassign<stale_member_value>("stale members (before)", 100000, 10000000);
+    bench_reassign<ini_parser::config_value>("config_value", 100000, 10000000);
+    bench_batch_io(10000);
+    return 0;
+}
@@ -0,0 +1,769 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 nguyenchiemminhvu@gmail.com
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef INI_BATCH_IO_H
+#define INI_BATCH_IO_H
+
+#include "ini_parser.h"
+
+#include <climits>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define INI_PARSER_HAS_IO_URING 1
+#else
+#define INI_PARSER_HAS_IO_URING 0
+#endif
+
+namespace ini_parser
+{
+    namespace detail
+    {
+        // One file-system operation in a batch. `result` follows the kernel
+        // convention: the return value on success, -errno on failure. It stays
+        // -ECANCELED for an operation that never ran.
+        struct io_op
+        {
+            enum kind_type
+            {
+                OPEN,
+                STAT,
+                READ,
+                WRITE,
+                FSYNC,
+                CLOSE,
+                RENAME
+            };
+
+            kind_type kind;
+            int fd = -1;
+            const char* path = nullptr;
+            const char* new_path = nullptr;
+            int flags = 0;
+            mode_t mode = 0;
+            void* buffer = nullptr;
+            size_t length = 0;
+            uint64_t offset = 0;
+            struct statx* stat = nullptr;
+            int64_t result = -ECANCELED;
+        };
+
+        // Runs each operation with its own blocking syscall
+        inline void run_blocking(io_op& op) noexcept
+        {
+            long ret = -1;
+            switch (op.kind)
+            {
+                case io_op::OPEN:
+                    ret = ::open(op.path, op.flags, op.mode);
+                    break;
+                case io_op::STAT:
+                    ret = ::statx(op.fd, "", AT_EMPTY_PATH, STATX_SIZE, op.stat);
+                    break;
+                case io_op::READ:
+                    ret = ::pread(op.fd, op.buffer, op.length, static_cast<off_t>(op.offset));
+                    break;
+                case io_op::WRITE:
+                    ret = ::pwrite(op.fd, op.buffer, op.length, static_cast<off_t>(op.offset));
+                    break;
+                case io_op::FSYNC:
+                    ret = ::fsync(op.fd);
+                    break;
+                case io_op::CLOSE:
+                    ret = ::close(op.fd);
+                    break;
+                case io_op::RENAME:
+                    ret = ::rename(op.path, op.new_path);
+                    break;
+            }
+            op.result = ret < 0 ? -errno : ret;
+        }
+
+#if INI_PARSER_HAS_IO_URING
+        // Minimal io_uring submission/completion ring driven by raw syscalls
+        class io_uring_ring
+        {
+        public:
+            explicit io_uring_ring(unsigned entries) noexcept
+            {
+                io_uring_params params;
+                std::memset(&params, 0, sizeof(params));
+
+                long fd = ::syscall(__NR_io_uring_setup, entries, &params);
+                if (fd < 0)
+                    return;
+                fd_ = static_cast<int>(fd);
+
+                sq_ring_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                cq_ring_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single_mmap)
+                    sq_ring_bytes_ = cq_ring_bytes_ = std::max(sq_ring_bytes_, cq_ring_bytes_);
+
+                sq_ring_ = ::mmap(nullptr, sq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                  fd_, IORING_OFF_SQ_RING);
+                if (sq_ring_ == MAP_FAILED)
+                {
+                    sq_ring_ = nullptr;
+                    return;
+                }
+
+                if (single_mmap)
+                {
+                    cq_ring_ = sq_ring_;
+                }
+                else
+                {
+                    cq_ring_ = ::mmap(nullptr, cq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                      fd_, IORING_OFF_CQ_RING);
+                    if (cq_ring_ == MAP_FAILED)
+                    {
+                        cq_ring_ = nullptr;
+                        return;
+                    }
+                }
+
+                sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+                void* sqes = ::mmap(nullptr, sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                    fd_, IORING_OFF_SQES);
+                if (sqes == MAP_FAILED)
+                    return;
+                sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+                char* sq = static_cast<char*>(sq_ring_);
+                sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+                sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+                sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+                char* cq = static_cast<char*>(cq_ring_);
+                cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+                cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+                cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+                cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+                entries_ = params.sq_entries;
+                ready_ = supports_required_ops();
+            }
+
+            ~io_uring_ring()
+            {
+                if (sqes_ != nullptr)
+                    ::munmap(sqes_, sqes_bytes_);
+                if (cq_ring_ != nullptr && cq_ring_ != sq_ring_)
+                    ::munmap(cq_ring_, cq_ring_bytes_);
+                if (sq_ring_ != nullptr)
+                    ::munmap(sq_ring_, sq_ring_bytes_);
+                if (fd_ >= 0)
+                    ::close(fd_);
+            }
+
+            io_uring_ring(const io_uring_ring&) = delete;
+            io_uring_ring& operator=(const io_uring_ring&) = delete;
+
+            bool ready() const { return ready_; }
+
+            // Submit ops[first, first + count) and wait for all of them; count <= entries().
+            // Returns the number of io_uring_enter calls made.
+            size_t run(io_op* ops, unsigned count) noexcept
+            {
+                unsigned tail = *sq_tail_;
+                for (unsigned i = 0; i < count; ++i)
+                {
+                    unsigned index = tail & sq_mask_;
+                    prepare(sqes_[index], ops[i], i);
+                    sq_array_[index] = index;
+                    ++tail;
+                }
+                __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+                size_t calls = 0;
+                unsigned to_submit = count;
+                unsigned completed = 0;
+                while (completed < count)
+                {
+                    long ret = ::syscall(__NR_io_uring_enter, fd_, to_submit, count - completed,
+                                         IORING_ENTER_GETEVENTS, nullptr, 0);
+                    ++calls;
+                    if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                    {
+                        // Ring is unusable; fail whatever has not completed
+                        int error = errno;
+                        for (unsigned i = 0; i < count; ++i)
+                        {
+                            if (ops[i].result == pending)
+                                ops[i].result = -error;
+                        }
+                        ready_ = false;
+                        return calls;
+                    }
+                    if (ret > 0)
+                        to_submit -= static_cast<unsigned>(ret);
+
+                    completed += reap(ops);
+                }
+                return calls;
+            }
+
+            unsigned entries() const { return entries_; }
+
+            static constexpr int64_t pending = INT64_MIN;
+
+        private:
+            void prepare(io_uring_sqe& sqe, io_op& op, unsigned user_data) noexcept
+            {
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.user_data = user_data;
+                sqe.fd = op.fd;
+                op.result = pending;
+
+                switch (op.kind)
+                {
+                    case io_op::OPEN:
+                        sqe.opcode = IORING_OP_OPENAT;
+                        sqe.fd = AT_FDCWD;
+                        sqe.addr = reinterpret_cast<uintptr_t>(op.path);
+                        sqe.len = op.mode;
+                        sqe.open_flags = static_cast<__u32>(op.flags);
+                        break;
+                    case io_op::STAT:
+                        sqe.opcode = IORING_OP_STATX;
+                        sqe.addr = reinterpret_cast<uintptr_t>("");
+                        sqe.len = STATX_SIZE;
+                        sqe.off = reinterpret_cast<uintptr_t>(op.stat);
+                        sqe.statx_flags = AT_EMPTY_PATH;
+                        break;
+                    case io_op::READ:
+                    case io_op::WRITE:
+                        sqe.opcode = op.kind == io_op::READ ? IORING_OP_READ : IORING_OP_WRITE;
+                        sqe.addr = reinterpret_cast<uintptr_t>(op.buffer);
+                        sqe.len = static_cast<__u32>(std::min<size_t>(op.length, UINT_MAX));
+                        sqe.off = op.offset;
+                        break;
+                    case io_op::FSYNC:
+                        sqe.opcode = IORING_OP_FSYNC;
+                        break;
+                    case io_op::CLOSE:
+                        sqe.opcode = IORING_OP_CLOSE;
+                        break;
+                    case io_op::RENAME:
+                        sqe.opcode = IORING_OP_RENAMEAT;
+                        sqe.fd = AT_FDCWD;
+                        sqe.addr = reinterpret_cast<uintptr_t>(op.path);
+                        sqe.len = static_cast<__u32>(AT_FDCWD);
+                        sqe.addr2 = reinterpret_cast<uintptr_t>(op.new_path);
+                        break;
+                }
+            }
+
+            unsigned reap(io_op* ops) noexcept
+            {
+                unsigned head = *cq_head_;
+                unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+                unsigned reaped = 0;
+                for (; head != tail; ++head, ++reaped)
+                {
+                    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                    ops[cqe.user_data].result = cqe.res;
+                }
+                __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+                return reaped;
+            }
+
+            // Kernels before 5.11 lack RENAMEAT; probe rather than fail halfway through a batch
+            bool supports_required_ops() noexcept
+            {
+                const size_t op_count = 256;
+                std::vector<char> storage(sizeof(io_uring_probe) + op_count * sizeof(io_uring_probe_op), 0);
+                io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+                if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, op_count) < 0)
+                    return false;
+
+                const int required[] = {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE,
+                                        IORING_OP_FSYNC, IORING_OP_CLOSE, IORING_OP_RENAMEAT};
+                for (int op : required)
+                {
+                    if (op > probe->last_op || (probe->ops[op].flags & IO_URING_OP_SUPPORTED) == 0)
+                        return false;
+                }
+                return true;
+            }
+
+            int fd_ = -1;
+            bool ready_ = false;
+            unsigned entries_ = 0;
+            void* sq_ring_ = nullptr;
+            void* cq_ring_ = nullptr;
+            size_t sq_ring_bytes_ = 0;
+            size_t cq_ring_bytes_ = 0;
+            size_t sqes_bytes_ = 0;
+            io_uring_sqe* sqes_ = nullptr;
+            unsigned* sq_tail_ = nullptr;
+            unsigned* sq_array_ = nullptr;
+            unsigned sq_mask_ = 0;
+            unsigned* cq_head_ = nullptr;
+            unsigned* cq_tail_ = nullptr;
+            unsigned cq_mask_ = 0;
+            io_uring_cqe* cqes_ = nullptr;
+        };
+#endif
+    }
+
+    // Reads and writes many files at once. Each stage (open, stat, read, ...) is
+    // submitted for a whole chunk of files through one io_uring queue, so N files
+    // cost a handful of io_uring_enter calls per chunk instead of several syscalls
+    // per file. A chunk is at most the queue depth and a quarter of RLIMIT_NOFILE,
+    // and its files are closed before the next chunk is opened, so any number of
+    // files fits under the descriptor limit. Falls back to plain blocking syscalls
+    // where io_uring is missing or disabled, or fails part-way.
+    class batch_io
+    {
+    public:
+        enum class backend
+        {
+            AUTO,
+            BLOCKING
+        };
+
+        explicit batch_io(backend mode = backend::AUTO, unsigned queue_depth = 256)
+            : queue_depth_(std::max(queue_depth, 1u))
+        {
+#if INI_PARSER_HAS_IO_URING
+            if (mode == backend::AUTO)
+            {
+                ring_.reset(new detail::io_uring_ring(queue_depth));
+                if (!ring_->ready())
+                    ring_.reset();
+            }
+#else
+            (void)mode;
+#endif
+        }
+
+        bool uses_io_uring() const
+        {
+#if INI_PARSER_HAS_IO_URING
+            return ring_ != nullptr;
+#else
+            return false;
+#endif
+        }
+
+        // Syscalls issued so far (io_uring_enter calls, or one per blocking operation)
+        size_t syscall_count() const { return syscalls_; }
+
+        // Read each file whole; results are in input order
+        std::vector<expected<std::string, config_error_code>> read_files(const std::vector<std::string>& paths)
+        {
+            std::vector<expected<std::string, config_error_code>> results;
+            results.reserve(paths.size());
+            const size_t chunk = chunk_size();
+            for (size_t first = 0; first < paths.size(); first += chunk)
+                read_chunk(&paths[first], std::min(chunk, paths.size() - first), results);
+            return results;
+        }
+
+        // Replace each file atomically: write "<path>.tmp", optionally fsync it, then
+        // rename it over the target. Returns the bytes written per file.
+        std::vector<expected<size_t, config_error_code>> write_files(const std::vector<std::string>& paths,
+                                                                     const std::vector<std::string>& contents,
+                                                                     bool sync = true)
+        {
+            const size_t count = std::min(paths.size(), contents.size());
+            std::vector<expected<size_t, config_error_code>> results;
+            results.reserve(count);
+            const size_t chunk = chunk_size();
+            for (size_t first = 0; first < count; first += chunk)
+                write_chunk(&paths[first], &contents[first], std::min(chunk, count - first), sync, results);
+            return results;
+        }
+
+    private:
+        // Files open at once: the queue depth, and a quarter of the soft descriptor
+        // limit to leave room for the rest of the process
+        size_t chunk_size() const
+        {
+            size_t chunk = queue_depth_;
+#if INI_PARSER_HAS_IO_URING
+            if (ring_ != nullptr)
+                chunk = ring_->entries();
+#endif
+            struct rlimit limit;
+            if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+                chunk = std::min<size_t>(chunk, static_cast<size_t>(limit.rlim_cur / 4));
+            return std::max<size_t>(chunk, 1);
+        }
+
+        void read_chunk(const std::string* paths, size_t count, std::vector<expected<std::string, config_error_code>>& results)
+        {
+            std::vector<std::string> contents(count);
+            std::vector<config_error_code> errors(count, config_error_code::FILE_READ_FAILED);
+            std::vector<bool> failed(count, false);
+            std::vector<int> fds(count, -1);
+            std::vector<struct statx> stats(count);
+            std::vector<detail::io_op> ops;
+            std::vector<size_t> owners;
+
+            ops.reserve(count);
+            owners.reserve(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                detail::io_op op{detail::io_op::OPEN};
+                op.path = paths[i].c_str();
+                op.flags = O_RDONLY | O_CLOEXEC;
+                add(ops, owners, op, i);
+            }
+            run(ops);
+            for (size_t n = 0; n < ops.size(); ++n)
+            {
+                if (ops[n].result < 0)
+                    fail(failed, errors, owners[n], config_error_code::FILE_OPEN_FAILED);
+                else
+                    fds[owners[n]] = static_cast<int>(ops[n].result);
+            }
+
+            reset(ops, owners);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (failed[i])
+                    continue;
+                detail::io_op op{detail::io_op::STAT};
+                op.fd = fds[i];
+                op.stat = &stats[i];
+                add(ops, owners, op, i);
+            }
+            run(ops);
+            for (size_t n = 0; n < ops.size(); ++n)
+            {
+                size_t i = owners[n];
+                if (ops[n].result < 0)
+                {
+                    fail(failed, errors, i, config_error_code::FILE_READ_FAILED);
+                    continue;
+                }
+                try
+                {
+                    contents[i].resize(static_cast<size_t>(stats[i].stx_size));
+                }
+                catch (const std::bad_alloc&)
+                {
+                    fail(failed, errors, i, config_error_code::OUT_OF_MEMORY);
+                }
+            }
+
+            // Files are read up to their size at stat time; short reads are resubmitted
+            std::vector<size_t> done(count, 0);
+            transfer(detail::io_op::READ, fds, failed, errors, done,
+                     [&](size_t i) { return std::make_pair(&contents[i][0], contents[i].size()); },
+                     [&](size_t i) { contents[i].resize(done[i]); });
+
+            close_all(fds);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (failed[i])
+                    results.emplace_back(unexpected(errors[i]));
+                else
+                    results.emplace_back(std::move(contents[i]));
+            }
+        }
+
+        void write_chunk(const std::string* paths, const std::string* contents, size_t count, bool sync,
+                         std::vector<expected<size_t, config_error_code>>& results)
+        {
+            std::vector<std::string> temp_paths(count);
+            std::vector<config_error_code> errors(count, config_error_code::FILE_WRITE_FAILED);
+            std::vector<bool> failed(count, false);
+            std::vector<int> fds(count, -1);
+            std::vector<detail::io_op> ops;
+            std::vector<size_t> owners;
+
+            ops.reserve(count);
+            owners.reserve(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                temp_paths[i] = paths[i] + ".tmp";
+                detail::io_op op{detail::io_op::OPEN};
+                op.path = temp_paths[i].c_str();
+                op.flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+                op.mode = 0644;
+                add(ops, owners, op, i);
+            }
+            run(ops);
+            for (size_t n = 0; n < ops.size(); ++n)
+            {
+                if (ops[n].result < 0)
+                    fail(failed, errors, owners[n], config_error_code::FILE_OPEN_FAILED);
+                else
+                    fds[owners[n]] = static_cast<int>(ops[n].result);
+            }
+
+            std::vector<size_t> done(count, 0);
+            transfer(detail::io_op::WRITE, fds, failed, errors, done,
+                     [&](size_t i) { return std::make_pair(const_cast<char*>(contents[i].data()), contents[i].size()); },
+                     [&](size_t i) { fail(failed, errors, i, config_error_code::FILE_WRITE_FAILED); });
+
+            if (sync)
+            {
+                reset(ops, owners);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (failed[i])
+                        continue;
+                    detail::io_op op{detail::io_op::FSYNC};
+                    op.fd = fds[i];
+                    add(ops, owners, op, i);
+                }
+                run(ops);
+                for (size_t n = 0; n < ops.size(); ++n)
+                {
+                    if (ops[n].result < 0)
+                        fail(failed, errors, owners[n], config_error_code::FILE_WRITE_FAILED);
+                }
+            }
+
+            std::vector<bool> close_failed = close_all(fds);
+
+            reset(ops, owners);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (close_failed[i])
+                    fail(failed, errors, i, config_error_code::FILE_WRITE_FAILED);
+                if (failed[i])
+                    continue;
+                detail::io_op op{detail::io_op::RENAME};
+                op.path = temp_paths[i].c_str();
+                op.new_path = paths[i].c_str();
+                add(ops, owners, op, i);
+            }
+            run(ops);
+            for (size_t n = 0; n < ops.size(); ++n)
+            {
+                if (ops[n].result < 0)
+                    fail(failed, errors, owners[n], config_error_code::FILE_WRITE_FAILED);
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (failed[i])
+                {
+                    // Leave no half-written temporaries behind
+                    if (errors[i] != config_error_code::FILE_OPEN_FAILED)
+                        ::unlink(temp_paths[i].c_str());
+                    results.emplace_back(unexpected(errors[i]));
+                }
+                else
+                {
+                    results.emplace_back(contents[i].size());
+                }
+            }
+        }
+
+        static void add(std::vector<detail::io_op>& ops, std::vector<size_t>& owners, const detail::io_op& op, size_t owner)
+        {
+            ops.push_back(op);
+            owners.push_back(owner);
+        }
+
+        static void reset(std::vector<detail::io_op>& ops, std::vector<size_t>& owners)
+        {
+            ops.clear();
+            owners.clear();
+        }
+
+        // Record the first error for a file
+        static void fail(std::vector<bool>& failed, std::vector<config_error_code>& errors, size_t i, config_error_code code)
+        {
+            if (!failed[i])
+            {
+                failed[i] = true;
+                errors[i] = code;
+            }
+        }
+
+        void run(std::vector<detail::io_op>& ops) noexcept
+        {
+#if INI_PARSER_HAS_IO_URING
+            if (ring_ != nullptr)
+            {
+                size_t first = 0;
+                while (first < ops.size() && ring_->ready())
+                {
+                    unsigned batch = static_cast<unsigned>(std::min<size_t>(ring_->entries(), ops.size() - first));
+                    syscalls_ += ring_->run(&ops[first], batch);
+                    first += batch;
+                }
+                if (first == ops.size())
+                    return;
+
+                // The ring failed part-way: finish without it, now and for later calls
+                ring_.reset();
+                run_blocking(ops, first);
+                return;
+            }
+#endif
+            run_blocking(ops, 0);
+        }
+
+        void run_blocking(std::vector<detail::io_op>& ops, size_t first) noexcept
+        {
+            for (size_t n = first; n < ops.size(); ++n)
+            {
+                detail::run_blocking(ops[n]);
+                ++syscalls_;
+            }
+        }
+
+        // Read or write every open file to completion, resubmitting the remainder of
+        // short transfers. `span(i)` gives the file's buffer; `on_short(i)` runs when a
+        // transfer makes no progress (end of file for reads).
+        template<typename Span, typename OnShort>
+        void transfer(detail::io_op::kind_type kind, const std::vector<int>& fds, std::vector<bool>& failed,
+                      std::vector<config_error_code>& errors, std::vector<size_t>& done, Span span, OnShort on_short)
+        {
+            const config_error_code error = kind == detail::io_op::READ ? config_error_code::FILE_READ_FAILED
+                                                                        : config_error_code::FILE_WRITE_FAILED;
+            std::vector<detail::io_op> ops;
+            std::vector<size_t> owners;
+            std::vector<size_t> active;
+            for (size_t i = 0; i < fds.size(); ++i)
+            {
+                if (!failed[i] && span(i).second > 0)
+                    active.push_back(i);
+            }
+
+            while (!active.empty())
+            {
+                reset(ops, owners);
+                for (size_t i : active)
+                {
+                    std::pair<char*, size_t> buffer = span(i);
+                    detail::io_op op{kind};
+                    op.fd = fds[i];
+                    op.buffer = buffer.first + done[i];
+                    op.length = buffer.second - done[i];
+                    op.offset = done[i];
+                    add(ops, owners, op, i);
+                }
+                run(ops);
+
+                active.clear();
+                for (size_t n = 0; n < ops.size(); ++n)
+                {
+                    size_t i = owners[n];
+                    if (ops[n].result < 0)
+                    {
+                        fail(failed, errors, i, error);
+                    }
+                    else if (ops[n].result == 0)
+                    {
+                        on_short(i);
+                    }
+                    else
+                    {
+                        done[i] += static_cast<size_t>(ops[n].result);
+                        if (done[i] < span(i).second)
+                            active.push_back(i);
+                    }
+                }
+            }
+        }
+
+        // Close every open descriptor; reports which closes failed
+        std::vector<bool> close_all(std::vector<int>& fds)
+        {
+            std::vector<detail::io_op> ops;
+            std::vector<size_t> owners;
+            std::vector<bool> close_failed(fds.size(), false);
+            for (size_t i = 0; i < fds.size(); ++i)
+            {
+                if (fds[i] < 0)
+                    continue;
+                detail::io_op op{detail::io_op::CLOSE};
+                op.fd = fds[i];
+                add(ops, owners, op, i);
+            }
+            run(ops);
+            for (size_t n = 0; n < ops.size(); ++n)
+            {
+                close_failed[owners[n]] = ops[n].result < 0;
+                fds[owners[n]] = -1;
+            }
+            return close_failed;
+        }
+
+#if INI_PARSER_HAS_IO_URING
+        std::unique_ptr<detail::io_uring_ring> ring_;
+#endif
+        size_t queue_depth_;
+        size_t syscalls_ = 0;
+    };
+
+    // Load each file into the parser at the same index; `parsers` is resized to match
+    inline std::vector<expected<size_t, config_error_code>> load_files(batch_io& io,
+                                                                       const std::vector<std::string>& paths,
+                                                                       std::vector<ini_parser>& parsers,
+                                                                       merge_strategy strategy = merge_strategy::OVERWRITE)
+    {
+        std::vector<expected<std::string, config_error_code>> contents = io.read_files(paths);
+        parsers.resize(paths.size());
+
+        std::vector<expected<size_t, config_error_code>> results;
+        results.reserve(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            if (!contents[i])
+                results.emplace_back(unexpected(contents[i].error()));
+            else
+                results.push_back(parsers[i].try_load_from_buffer(contents[i].value(), strategy));
+        }
+        return results;
+    }
+
+    // Save each parser to the path at the same index, atomically
+    inline std::vector<expected<size_t, config_error_code>> save_files(batch_io& io,
+                                                                       const std::vector<std::string>& paths,
+                                                                       const std::vector<const ini_parser*>& parsers,
+                                                                       bool sync = true)
+    {
+        std::vector<std::string> contents;
+        contents.reserve(parsers.size());
+        for (const ini_parser* parser : parsers)
+            contents.push_back(parser->to_ini_string());
+
+        std::vector<expected<size_t, config_error_code>> results = io.write_files(paths, contents, sync);
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            if (results[i])
+                results[i] = expected<size_t, config_error_code>(parsers[i]->size());
+        }
+        return results;
+    }
+}
+
+#endif // INI_BATCH_IO_H
@@ -28,11 +28,37 @@
 #include <string>
 #include <map>
 #include <unordered_map>
+#include <set>
 #include <stdexcept>
+#include <exception>
 #include <vector>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <memory>
+#include <string_view>
+#include <variant>
+#include <charconv>
+#include <cmath>
+#include <cctype>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <thread>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace ini_parser
 {
@@ -42,6 +68,59 @@ namespace ini_parser
         PRESERVE   // keep old value if present
     };
 
+    enum class key_case
+    {
+        SENSITIVE,  // keys match exactly
+        INSENSITIVE // ASCII letters in keys match regardless of case
+    };
+
+    // True if `str` contains an ASCII upper-case letter
+    inline bool has_ascii_upper(std::string_view str)
+    {
+        const char* p = str.data();
+        const char* end = p + str.size();
+#if defined(__SSE2__)
+        // Bytes >= 0x80 are negative as signed chars, so they never fall in ['A', 'Z']
+        const __m128i below_a = _mm_set1_epi8('A' - 1);
+        const __m128i above_z = _mm_set1_epi8('Z' + 1);
+        for (; end - p >= 16; p += 16)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chunk, below_a), _mm_cmplt_epi8(chunk, above_z));
+            if (_mm_movemask_epi8(upper) != 0)
+                return true;
+        }
+#endif
+        for (; p < end; ++p)
+        {
+            if (*p >= 'A' && *p <= 'Z')
+                return true;
+        }
+        return false;
+    }
+
+    // Lower-case the ASCII letters of `in` into `out` (may alias `in`)
+    inline void fold_ascii(const char* in, size_t length, char* out)
+    {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i below_a = _mm_set1_epi8('A' - 1);
+        const __m128i above_z = _mm_set1_epi8('Z' + 1);
+        const __m128i case_bit = _mm_set1_epi8(0x20);
+        for (; i + 16 <= length; i += 16)
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chunk, below_a), _mm_cmplt_epi8(chunk, above_z));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_or_si128(chunk, _mm_and_si128(upper, case_bit)));
+        }
+#endif
+        for (; i < length; ++i)
+        {
+            char c = in[i];
+            out[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+        }
+    }
+
     class config_error : public std::runtime_error
     {
     public:
@@ -60,6 +139,120 @@ namespace ini_parser
         explicit parse_error(const std::string& msg) : config_error(msg) {}
     };
 
+    // Error codes reported by the non-throwing try_* API
+    enum class config_error_code
+    {
+        FILE_OPEN_FAILED,
+        FILE_READ_FAILED,
+        FILE_WRITE_FAILED,
+        INVALID_SYNTAX,
+        KEY_NOT_FOUND,
+        OUT_OF_MEMORY
+    };
+
+    // Error half of an expected, e.g. `return unexpected(config_error_code::KEY_NOT_FOUND);`
+    template<typename E>
+    struct unexpected
+    {
+        explicit unexpected(E e) : error(std::move(e)) {}
+        E error;
+    };
+
+    // Minimal std::expected stand-in for C++17: holds either a value or an error
+    template<typename T, typename E>
+    class expected
+    {
+    public:
+        expected(const T& value) : storage_(std::in_place_index<0>, value) {}
+        expected(T&& value) : storage_(std::in_place_index<0>, std::move(value)) {}
+        expected(unexpected<E> failure) : storage_(std::in_place_index<1>, std::move(failure.error)) {}
+
+        bool has_value() const noexcept { return storage_.index() == 0; }
+        explicit operator bool() const noexcept { return has_value(); }
+
+        // Precondition: has_value()
+        T& value() & { return std::get<0>(storage_); }
+        const T& value() const & { return std::get<0>(storage_); }
+        T&& value() && { return std::get<0>(std::move(storage_)); }
+
+        // Precondition: !has_value()
+        const E& error() const { return std::get<1>(storage_); }
+
+        T value_or(T fallback) const { return has_value() ? std::get<0>(storage_) : std::move(fallback); }
+
+    private:
+        std::variant<T, E> storage_;
+    };
+
+    // Append `str` to `out` as a quoted JSON string.
+    // Runs of bytes that need no escaping are found 16 at a time with SSE2 and
+    // copied in bulk; the scalar loop only handles the bytes that must be escaped.
+    inline void append_json_string(std::string& out, std::string_view str)
+    {
+        static const char hex_digits[] = "0123456789abcdef";
+
+        out.reserve(out.size() + str.size() + 2);
+        out += '"';
+
+        const char* p = str.data();
+        const char* end = p + str.size();
+        while (p < end)
+        {
+            const char* run = p;
+#if defined(__SSE2__)
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i control_max = _mm_set1_epi8(0x1F);
+            while (end - p >= 16)
+            {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                // Unsigned c <= 0x1F  <=>  max(c, 0x1F) == 0x1F
+                __m128i special = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                    _mm_cmpeq_epi8(_mm_max_epu8(chunk, control_max), control_max));
+                int mask = _mm_movemask_epi8(special);
+                if (mask != 0)
+                {
+                    p += __builtin_ctz(static_cast<unsigned>(mask));
+                    break;
+                }
+                p += 16;
+            }
+#endif
+            while (p < end)
+            {
+                unsigned char c = static_cast<unsigned char>(*p);
+                if (c == '"' || c == '\\' || c < 0x20)
+                    break;
+                ++p;
+            }
+            out.append(run, static_cast<size_t>(p - run));
+
+            if (p == end)
+                break;
+
+            unsigned char c = static_cast<unsigned char>(*p++);
+            switch (c)
+            {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                default:
+                {
+                    char escaped[6] = { '\\', 'u', '0', '0', hex_digits[c >> 4], hex_digits[c & 0xF] };
+                    out.append(escaped, sizeof(escaped));
+                    break;
+                }
+            }
+        }
+
+        out += '"';
+    }
+
     class config_value
     {
     public:
@@ -103,10 +296,16 @@ namespace ini_parser
         
         config_value(const std::string& value) : type_(value_type::TYPE_STRING), int_value(0), string_value(value) {}
         
+        config_value(std::string&& value) : type_(value_type::TYPE_STRING), int_value(0), string_value(std::move(value)) {}
+        
         config_value(const std::vector<config_value>& value) : type_(value_type::TYPE_ARRAY), int_value(0), array_value(value) {}
         
         config_value(const std::map<std::string, config_value>& value) : type_(value_type::TYPE_OBJECT), int_value(0), object_value(value) {}
         
+        config_value(std::vector<config_value>&& value) : type_(value_type::TYPE_ARRAY), int_value(0), array_value(std::move(value)) {}
+        
+        config_value(std::map<std::string, config_value>&& value) : type_(value_type::TYPE_OBJECT), int_value(0), object_value(std::move(value)) {}
+        
         // Copy constructor
         config_value(const config_value& other) : type_(other.type_), int_value(0)
         {
@@ -120,23 +319,36 @@ namespace ini_parser
         }
         
         // Copy assignment
+        // Copies first, so `other` may live inside this value and a failed copy leaves it intact
         config_value& operator=(const config_value& other)
         {
-            if (this != &other)
+            if (this == &other)
+                return *this;
+            
+            if (type_ == value_type::TYPE_STRING && other.type_ == value_type::TYPE_STRING)
+            {
+                // A string cannot contain *this, so reuse the existing buffer
+                string_value = other.string_value;
+            }
+            else
             {
-                type_ = other.type_;
-                copy_from(other);
+                config_value incoming(other);
+                *this = std::move(incoming);
             }
             return *this;
         }
         
         // Move assignment
+        // The previous alternative is destroyed and `other` is left TYPE_NULL
         config_value& operator=(config_value&& other) noexcept
         {
             if (this != &other)
             {
-                type_ = other.type_;
-                move_from(std::move(other));
+                // Detach first: `other` may be an element of the array/object being released
+                config_value incoming(std::move(other));
+                release();
+                type_ = incoming.type_;
+                move_from(std::move(incoming));
             }
             return *this;
         }
@@ -154,6 +366,45 @@ namespace ini_parser
         bool is_object() const { return type_ == value_type::TYPE_OBJECT; }
         bool is_number() const { return is_int() || is_double(); }
         
+        // Estimated heap bytes owned by this value (strings past the SSO buffer,
+        // array storage, object nodes), not counting sizeof(config_value) itself
+        size_t memory_usage() const
+        {
+            size_t bytes = 0;
+            switch (type_)
+            {
+                case value_type::TYPE_STRING:
+                    bytes += string_heap_bytes(string_value);
+                    break;
+                case value_type::TYPE_ARRAY:
+                    bytes += array_value.capacity() * sizeof(config_value);
+                    for (const config_value& item : array_value)
+                        bytes += item.memory_usage();
+                    break;
+                case value_type::TYPE_OBJECT:
+                    for (const auto& member : object_value)
+                        bytes += map_node_bytes() + string_heap_bytes(member.first) + member.second.memory_usage();
+                    break;
+                default:
+                    break;
+            }
+            return bytes;
+        }
+        
+        // Rough per-node cost of the std::map used for objects and parser stores:
+        // the stored pair plus color and parent/left/right links
+        static size_t map_node_bytes()
+        {
+            return sizeof(std::pair<const std::string, config_value>) + 4 * sizeof(void*);
+        }
+        
+        static size_t string_heap_bytes(const std::string& str)
+        {
+            // Capacity beyond what fits inline means a separate allocation
+            static const size_t inline_capacity = std::string().capacity();
+            return str.capacity() > inline_capacity ? str.capacity() + 1 : 0;
+        }
+        
         // Value getters with type checking
         bool as_bool() const
         {
@@ -326,7 +577,107 @@ namespace ini_parser
             return !(*this == other);
         }
         
+        // JSON serialization. The appending overload lets callers reuse one buffer.
+        // Non-finite doubles have no JSON representation and are written as null.
+        void to_json(std::string& out) const
+        {
+            char number[32];
+            switch (type_)
+            {
+                case value_type::TYPE_NULL:
+                    out += "null";
+                    break;
+                case value_type::TYPE_BOOL:
+                    out += bool_value ? "true" : "false";
+                    break;
+                case value_type::TYPE_INT:
+                {
+                    std::to_chars_result result = std::to_chars(number, number + sizeof(number), int_value);
+                    out.append(number, result.ptr);
+                    break;
+                }
+                case value_type::TYPE_DOUBLE:
+                {
+                    if (!std::isfinite(double_value))
+                    {
+                        out += "null";
+                        break;
+                    }
+                    std::to_chars_result result = std::to_chars(number, number + sizeof(number), double_value);
+                    out.append(number, result.ptr);
+                    // Keep doubles distinguishable from ints when read back
+                    if (std::find_if(number, result.ptr, [](char c) { return c == '.' || c == 'e'; }) == result.ptr)
+                        out += ".0";
+                    break;
+                }
+                case value_type::TYPE_STRING:
+                    append_json_string(out, string_value);
+                    break;
+                case value_type::TYPE_ARRAY:
+                {
+                    out += '[';
+                    for (size_t i = 0; i < array_value.size(); ++i)
+                    {
+                        if (i != 0)
+                            out += ',';
+                        array_value[i].to_json(out);
+                    }
+                    out += ']';
+                    break;
+                }
+                case value_type::TYPE_OBJECT:
+                {
+                    out += '{';
+                    bool first = true;
+                    for (const auto& member : object_value)
+                    {
+                        if (!first)
+                            out += ',';
+                        first = false;
+                        append_json_string(out, member.first);
+                        out += ':';
+                        member.second.to_json(out);
+                    }
+                    out += '}';
+                    break;
+                }
+            }
+        }
+        
+        std::string to_json() const
+        {
+            std::string out;
+            to_json(out);
+            return out;
+        }
+        
+        // Parse a JSON document; throws parse_error on malformed input.
+        // Integers that fit in int become TYPE_INT, other numbers TYPE_DOUBLE.
+        static config_value from_json(std::string_view json);
+        
     private:
+        // Free the storage of the current alternative and become TYPE_NULL.
+        // Only the member matching type_ ever holds data, so that is the only one to free.
+        void release() noexcept
+        {
+            switch (type_)
+            {
+                case value_type::TYPE_STRING:
+                    std::string().swap(string_value);
+                    break;
+                case value_type::TYPE_ARRAY:
+                    std::vector<config_value>().swap(array_value);
+                    break;
+                case value_type::TYPE_OBJECT:
+                    object_value.clear();
+                    break;
+                default:
+                    break;
+            }
+            type_ = value_type::TYPE_NULL;
+            int_value = 0;
+        }
+        
         void copy_from(const config_value& other)
         {
             switch (other.type_)
@@ -379,69 +730,638 @@ namespace ini_parser
                 default:
                     break;
             }
+            
+            // Leave the source as an empty TYPE_NULL value
+            other.release();
         }
     };
 
+    namespace detail
+    {
+        // Recursive-descent JSON reader producing config_value trees
+        class json_reader
+        {
+        public:
+            explicit json_reader(std::string_view text) : text_(text), pos_(0) {}
+
+            config_value read_document()
+            {
+                config_value value = read_value(0);
+                skip_whitespace();
+                if (pos_ != text_.size())
+                    fail("unexpected trailing characters");
+                return value;
+            }
+
+            // Read the top-level object member by member, for callers that store members themselves
+            template<typename Callback>
+            void read_members(Callback on_member)
+            {
+                skip_whitespace();
+                expect('{');
+                skip_whitespace();
+                if (peek() == '}')
+                {
+                    ++pos_;
+                }
+                else
+                {
+                    std::string key;
+                    while (true)
+                    {
+                        skip_whitespace();
+                        key.clear();
+                        read_string(key);
+                        skip_whitespace();
+                        expect(':');
+                        on_member(key, read_value(1));
+                        skip_whitespace();
+                        if (peek() == ',')
+                        {
+                            ++pos_;
+                            continue;
+                        }
+                        expect('}');
+                        break;
+                    }
+                }
+                skip_whitespace();
+                if (pos_ != text_.size())
+                    fail("unexpected trailing characters");
+            }
+
+        private:
+            static const size_t max_depth = 512;
+
+            std::string_view text_;
+            size_t pos_;
+
+            [[noreturn]] void fail(const char* reason) const
+            {
+                throw parse_error("Invalid JSON at offset " + std::to_string(pos_) + ": " + reason);
+            }
+
+            char peek() const
+            {
+                return pos_ < text_.size() ? text_[pos_] : '\0';
+            }
+
+            void expect(char c)
+            {
+                if (peek() != c)
+                    fail("unexpected character");
+                ++pos_;
+            }
+
+            void skip_whitespace()
+            {
+                while (pos_ < text_.size() &&
+                       (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r'))
+                    ++pos_;
+            }
+
+            bool consume_literal(std::string_view literal)
+            {
+                if (text_.compare(pos_, literal.size(), literal) != 0)
+                    return false;
+                pos_ += literal.size();
+                return true;
+            }
+
+            config_value read_value(size_t depth)
+            {
+                if (depth > max_depth)
+                    fail("nesting too deep");
+
+                skip_whitespace();
+                switch (peek())
+                {
+                    case '{':
+                    {
+                        ++pos_;
+                        std::map<std::string, config_value> members;
+                        skip_whitespace();
+                        if (peek() == '}')
+                        {
+                            ++pos_;
+                            return config_value(std::move(members));
+                        }
+                        std::string key;
+                        while (true)
+                        {
+                            skip_whitespace();
+                            key.clear();
+                            read_string(key);
+                            skip_whitespace();
+                            expect(':');
+                            members[key] = read_value(depth + 1);
+                            skip_whitespace();
+                            if (peek() == ',')
+                            {
+                                ++pos_;
+                                continue;
+                            }
+                            expect('}');
+                            return config_value(std::move(members));
+                        }
+                    }
+                    case '[':
+                    {
+                        ++pos_;
+                        std::vector<config_value> items;
+                        skip_whitespace();
+                        if (peek() == ']')
+                        {
+                            ++pos_;
+                            return config_value(std::move(items));
+                        }
+                        while (true)
+                        {
+                            items.push_back(read_value(depth + 1));
+                            skip_whitespace();
+                            if (peek() == ',')
+                            {
+                                ++pos_;
+                                continue;
+                            }
+                            expect(']');
+                            return config_value(std::move(items));
+                        }
+                    }
+                    case '"':
+                    {
+                        std::string str;
+                        read_string(str);
+                        return config_value(std::move(str));
+                    }
+                    case 't':
+                        if (consume_literal("true"))
+                            return config_value(true);
+                        break;
+                    case 'f':
+                        if (consume_literal("false"))
+                            return config_value(false);
+                        break;
+                    case 'n':
+                        if (consume_literal("null"))
+                            return config_value();
+                        break;
+                    default:
+                        return read_number();
+                }
+                fail("invalid literal");
+            }
+
+            config_value read_number()
+            {
+                size_t start = pos_;
+                bool integral = true;
+                if (peek() == '-')
+                    ++pos_;
+                if (!std::isdigit(static_cast<unsigned char>(peek())))
+                    fail("invalid value");
+                while (pos_ < text_.size())
+                {
+                    char c = text_[pos_];
+                    if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')
+                        integral = false;
+                    else if (!std::isdigit(static_cast<unsigned char>(c)))
+                        break;
+                    ++pos_;
+                }
+
+                const char* first = text_.data() + start;
+                const char* last = text_.data() + pos_;
+                if (integral)
+                {
+                    int i;
+                    std::from_chars_result result = std::from_chars(first, last, i);
+                    if (result.ec == std::errc() && result.ptr == last)
+                        return config_value(i);
+                }
+
+                double d;
+                std::from_chars_result result = std::from_chars(first, last, d);
+                if (result.ec != std::errc() || result.ptr != last)
+                    fail("invalid number");
+                return config_value(d);
+            }
+
+            unsigned read_hex4()
+            {
+                if (text_.size() - pos_ < 4)
+                    fail("truncated unicode escape");
+                unsigned code = 0;
+                for (int i = 0; i < 4; ++i)
+                {
+                    char c = text_[pos_++];
+                    code <<= 4;
+                    if (c >= '0' && c <= '9')
+                        code |= static_cast<unsigned>(c - '0');
+                    else if (c >= 'a' && c <= 'f')
+                        code |= static_cast<unsigned>(c - 'a' + 10);
+                    else if (c >= 'A' && c <= 'F')
+                        code |= static_cast<unsigned>(c - 'A' + 10);
+                    else
+                        fail("invalid unicode escape");
+                }
+                return code;
+            }
+
+            static void append_utf8(std::string& out, unsigned code)
+            {
+                if (code < 0x80)
+                {
+                    out += static_cast<char>(code);
+                }
+                else if (code < 0x800)
+                {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000)
+                {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else
+                {
+                    out += static_cast<char>(0xF0 | (code >> 18));
+                    out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+
+            void read_string(std::string& out)
+            {
+                expect('"');
+                while (true)
+                {
+                    // Copy the unescaped run in one go
+                    size_t run = pos_;
+                    while (pos_ < text_.size() && text_[pos_] != '"' && text_[pos_] != '\\' &&
+                           static_cast<unsigned char>(text_[pos_]) >= 0x20)
+                        ++pos_;
+                    out.append(text_.data() + run, pos_ - run);
+
+                    if (pos_ >= text_.size())
+                        fail("unterminated string");
+
+                    char c = text_[pos_++];
+                    if (c == '"')
+                        return;
+                    if (c != '\\')
+                        fail("control character in string");
+                    if (pos_ >= text_.size())
+                        fail("unterminated string");
+
+                    switch (text_[pos_++])
+                    {
+                        case '"':  out += '"'; break;
+                        case '\\': out += '\\'; break;
+                        case '/':  out += '/'; break;
+                        case 'b':  out += '\b'; break;
+                        case 'f':  out += '\f'; break;
+                        case 'n':  out += '\n'; break;
+                        case 'r':  out += '\r'; break;
+                        case 't':  out += '\t'; break;
+                        case 'u':
+                        {
+                            unsigned code = read_hex4();
+                            if (code >= 0xD800 && code <= 0xDBFF)
+                            {
+                                // High surrogate must be followed by an escaped low surrogate
+                                if (!consume_literal("\\u"))
+                                    fail("unpaired surrogate");
+                                unsigned low = read_hex4();
+                                if (low < 0xDC00 || low > 0xDFFF)
+                                    fail("unpaired surrogate");
+                                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                            }
+                            else if (code >= 0xDC00 && code <= 0xDFFF)
+                            {
+                                fail("unpaired surrogate");
+                            }
+                            append_utf8(out, code);
+                            break;
+                        }
+                        default:
+                            fail("invalid escape");
+                    }
+                }
+            }
+        };
+    }
+
+    namespace detail
+    {
+        // Resident set size of this process in bytes (Linux /proc), 0 if unavailable
+        inline size_t resident_bytes()
+        {
+            std::ifstream statm("/proc/self/statm");
+            size_t total_pages = 0;
+            size_t resident_pages = 0;
+            if (!(statm >> total_pages >> resident_pages))
+                return 0;
+            return resident_pages * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        }
+    }
+
+    inline config_value config_value::from_json(std::string_view json)
+    {
+        return detail::json_reader(json).read_document();
+    }
+
     class base_ini_parser
     {
     protected:
-        std::map<std::string, config_value> data_;
+        // Transparent comparator so keys can be looked up from a string_view without allocating
+        typedef std::map<std::string, config_value, std::less<>> store_type;
+        typedef std::map<std::string, std::string, std::less<>> spelling_type;
+
+        store_type data_;
+
+        // Case-insensitive mode stores keys folded to lower case; spelling_ maps a folded key
+        // to the spelling it was first inserted with, when the two differ
+        bool case_insensitive_;
+        spelling_type spelling_;
+
+        // Auto-compaction: entries removed since the last rebuild, and the share of
+        // the store they must reach before remove() compacts (0 = disabled)
+        size_t removed_since_compact_;
+        double auto_compact_ratio_;
+        size_t auto_compact_min_removed_;
         
     public:
-        base_ini_parser() = default;
+        explicit base_ini_parser(key_case mode = key_case::SENSITIVE)
+            : case_insensitive_(mode == key_case::INSENSITIVE), removed_since_compact_(0),
+              auto_compact_ratio_(0.0), auto_compact_min_removed_(0) {}
         virtual ~base_ini_parser() = default;
         virtual bool load(const std::string &source, merge_strategy strategy = merge_strategy::OVERWRITE) = 0;
         virtual bool save(const std::string &destination) const = 0;
 
         virtual void merge(const base_ini_parser &other, merge_strategy strategy = merge_strategy::OVERWRITE)
         {
+            if (case_insensitive_ || other.case_insensitive_)
+            {
+                // Re-key through the other parser's original spelling
+                other.for_each_spelled([&](const std::string& key, const config_value& value)
+                {
+                    if (strategy == merge_strategy::OVERWRITE || !has(key))
+                        slot(key) = value;
+                });
+                return;
+            }
+
             for (const auto& pair : other.data_)
             {
-                if (strategy == merge_strategy::OVERWRITE || !has(pair.first))
+                if (strategy == merge_strategy::OVERWRITE)
                 {
                     data_[pair.first] = pair.second;
                 }
+                else
+                {
+                    // insert() keeps an existing entry, no separate has() lookup needed
+                    data_.insert(pair);
+                }
             }
         }
 
-        bool has(const std::string& key) const
+        // Merge many parsers in one k-way ordered pass.
+        // Same result as calling base_ini_parser::merge() for each parser in order, but
+        // every key is resolved once. Large inputs are split by key range and merged
+        // concurrently. Not virtual, and it never calls merge(): an override of merge()
+        // does not apply here. Null entries are skipped; an empty list changes nothing.
+        void merge_all(const std::vector<const base_ini_parser*>& others, merge_strategy strategy = merge_strategy::OVERWRITE)
         {
-            return data_.find(key) != data_.end();
-        }
-        
-        config_value get(const std::string& key) const
+            // The k-way merge relies on every source sharing one key order; case-folded
+            // stores need re-keying, so they take the per-parser path
+            bool folding = case_insensitive_;
+            for (const base_ini_parser* other : others)
+                folding = folding || (other != nullptr && other->case_insensitive_);
+            if (folding)
+            {
+                for (const base_ini_parser* other : others)
+                {
+                    if (other != nullptr)
+                        base_ini_parser::merge(*other, strategy);
+                }
+                return;
+            }
+
+            // Source 0 is our own data, so PRESERVE favours it and OVERWRITE lets later parsers win
+            std::vector<const store_type*> sources;
+            sources.reserve(others.size() + 1);
+            sources.push_back(&data_);
+
+            size_t total = data_.size();
+            const store_type* largest = &data_;
+            for (const base_ini_parser* other : others)
+            {
+                if (other == nullptr)
+                    continue;
+                sources.push_back(&other->data_);
+                total += other->data_.size();
+                if (other->data_.size() > largest->size())
+                    largest = &other->data_;
+            }
+            if (sources.size() == 1)
+                return;
+
+            const size_t min_entries_per_task = 16384;
+            size_t tasks = std::max<size_t>(1, std::thread::hardware_concurrency());
+            tasks = std::min(tasks, total / min_entries_per_task);
+            tasks = std::min(tasks, largest->size());
+
+            if (tasks <= 1)
+            {
+                store_type merged = merge_range(sources, nullptr, nullptr, strategy);
+                data_.swap(merged);
+                removed_since_compact_ = 0;
+                return;
+            }
+
+            // Split points are evenly spaced keys of the largest source
+            std::vector<std::string> bounds;
+            bounds.reserve(tasks - 1);
+            auto it = largest->begin();
+            size_t position = 0;
+            for (size_t i = 1; i < tasks; ++i)
+            {
+                size_t target = largest->size() * i / tasks;
+                std::advance(it, target - position);
+                position = target;
+                bounds.push_back(it->first);
+            }
+
+            std::vector<std::future<store_type>> parts;
+            parts.reserve(tasks);
+            for (size_t i = 0; i < tasks; ++i)
+            {
+                const std::string* lo = (i == 0) ? nullptr : &bounds[i - 1];
+                const std::string* hi = (i == tasks - 1) ? nullptr : &bounds[i];
+                parts.push_back(std::async(std::launch::async, &base_ini_parser::merge_range, std::cref(sources), lo, hi, strategy));
+            }
+
+            // Ranges are disjoint and ordered, so nodes are spliced onto the end without copying
+            store_type merged = parts[0].get();
+            for (size_t i = 1; i < tasks; ++i)
+            {
+                store_type part = parts[i].get();
+                while (!part.empty())
+                {
+                    merged.insert(merged.end(), part.extract(part.begin()));
+                }
+            }
+            data_.swap(merged);
+            removed_since_compact_ = 0;
+        }
+
+        key_case case_mode() const
         {
-            auto it = data_.find(key);
+            return case_insensitive_ ? key_case::INSENSITIVE : key_case::SENSITIVE;
+        }
+
+        bool has(const std::string& key) const
+        {
+            return find_key(key) != data_.end();
+        }
+        
+        config_value get(const std::string& key) const
+        {
+            auto it = find_key(key);
             if (it == data_.end())
                 throw config_error("Key not found: " + key);
             return it->second;
         }
         
+        expected<config_value, config_error_code> try_get(const std::string& key) const noexcept
+        {
+            try
+            {
+                auto it = find_key(key);
+                if (it == data_.end())
+                    return unexpected(config_error_code::KEY_NOT_FOUND);
+                return it->second;
+            }
+            catch (...)
+            {
+                // Only copying the value can throw
+                return unexpected(config_error_code::OUT_OF_MEMORY);
+            }
+        }
+        
         config_value get(const std::string& key, const config_value& default_value) const
         {
-            auto it = data_.find(key);
+            auto it = find_key(key);
             return (it != data_.end()) ? it->second : default_value;
         }
         
         void set(const std::string& key, const config_value& value)
         {
-            data_[key] = value;
+            slot(key) = value;
         }
         
         template<typename T>
         void set(const std::string& key, const T& value)
         {
-            data_[key] = config_value(value);
+            slot(key) = config_value(value);
         }
         
+        // Erase `key`. With auto-compaction on (set_auto_compact()) this may rebuild the
+        // store, which invalidates every iterator into the parser, not just the erased one.
         bool remove(const std::string& key)
         {
-            return data_.erase(key) > 0;
+            key_probe probe(key, case_insensitive_);
+            auto it = data_.find(probe.view());
+            if (it == data_.end())
+                return false;
+            if (!spelling_.empty())
+            {
+                auto spelled = spelling_.find(probe.view());
+                if (spelled != spelling_.end())
+                    spelling_.erase(spelled);
+            }
+            data_.erase(it);
+
+            ++removed_since_compact_;
+            if (auto_compact_ratio_ > 0.0 && removed_since_compact_ >= auto_compact_min_removed_ &&
+                removed_since_compact_ >= auto_compact_ratio_ * (data_.size() + removed_since_compact_))
+            {
+                compact();
+            }
+            return true;
         }
         
         void clear()
         {
             data_.clear();
+            spelling_.clear();
+            removed_since_compact_ = 0;
+        }
+        
+        // Estimated heap bytes held by the store (nodes, keys, values)
+        size_t memory_usage() const
+        {
+            size_t bytes = 0;
+            for (const auto& pair : data_)
+                bytes += config_value::map_node_bytes() + config_value::string_heap_bytes(pair.first) + pair.second.memory_usage();
+            for (const auto& pair : spelling_)
+                bytes += config_value::map_node_bytes() + config_value::string_heap_bytes(pair.first) + config_value::string_heap_bytes(pair.second);
+            return bytes;
+        }
+        
+        struct compaction_result
+        {
+            size_t store_bytes_reclaimed;    // estimated excess capacity dropped from the store
+            size_t resident_bytes_reclaimed; // drop in process RSS, 0 where it cannot be measured
+        };
+
+        // Rebuild the store into fresh allocations made back to back in key order.
+        // Copies drop excess string/array capacity and leave the scattered nodes of
+        // earlier removals behind; freed heap pages are then handed back to the OS
+        // where the allocator supports it. Peak memory is briefly twice the store.
+        compaction_result compact()
+        {
+            size_t store_before = memory_usage();
+            size_t resident_before = detail::resident_bytes();
+
+            store_type fresh_data;
+            for (const auto& pair : data_)
+                fresh_data.emplace_hint(fresh_data.end(), pair.first, pair.second);
+            spelling_type fresh_spelling;
+            for (const auto& pair : spelling_)
+                fresh_spelling.emplace_hint(fresh_spelling.end(), pair.first, pair.second);
+
+            data_.swap(fresh_data);
+            spelling_.swap(fresh_spelling);
+            fresh_data.clear();
+            fresh_spelling.clear();
+            removed_since_compact_ = 0;
+
+#if defined(__GLIBC__)
+            malloc_trim(0);
+#endif
+
+            size_t store_after = memory_usage();
+            size_t resident_after = detail::resident_bytes();
+
+            compaction_result result;
+            result.store_bytes_reclaimed = store_before > store_after ? store_before - store_after : 0;
+            result.resident_bytes_reclaimed = resident_before > resident_after ? resident_before - resident_after : 0;
+            return result;
+        }
+        
+        // Compact from remove() once the removals since the last rebuild reach `removed_ratio`
+        // of the entries (live + removed), and at least `min_removed` entries. 0 disables.
+        // A remove() that compacts invalidates all iterators. Replacing the store (clear(),
+        // an OVERWRITE load, merge_all()) starts the count again.
+        void set_auto_compact(double removed_ratio, size_t min_removed = 1024)
+        {
+            auto_compact_ratio_ = removed_ratio;
+            auto_compact_min_removed_ = min_removed;
         }
         
         // Get all keys
@@ -456,6 +1376,75 @@ namespace ini_parser
             return keys;
         }
         
+        // Export as one flat JSON object keyed by full "section.key" names, which
+        // round-trips through from_json() without ambiguity
+        void to_json(std::string& out) const
+        {
+            out += '{';
+            bool first = true;
+            for_each_spelled([&](const std::string& key, const config_value& value)
+            {
+                if (!first)
+                    out += ',';
+                first = false;
+                append_json_string(out, key);
+                out += ':';
+                value.to_json(out);
+            });
+            out += '}';
+        }
+        
+        std::string to_json() const
+        {
+            std::string out;
+            to_json(out);
+            return out;
+        }
+        
+        // Import a flat JSON object as produced by to_json(); nested objects and arrays
+        // become TYPE_OBJECT/TYPE_ARRAY values. Throws parse_error on malformed input.
+        void from_json(std::string_view json, merge_strategy strategy = merge_strategy::OVERWRITE)
+        {
+            store_type loaded;
+            spelling_type loaded_spelling;
+            const bool fold = case_insensitive_;
+            detail::json_reader(json).read_members([&](const std::string& key, config_value&& value)
+            {
+                if (fold && has_ascii_upper(key))
+                {
+                    std::string folded(key);
+                    fold_ascii(folded.data(), folded.size(), &folded[0]);
+                    loaded_spelling.emplace(folded, key);
+                    loaded[folded] = std::move(value);
+                }
+                else
+                {
+                    loaded[key] = std::move(value);
+                }
+            });
+
+            if (strategy == merge_strategy::OVERWRITE)
+            {
+                data_.swap(loaded);
+                spelling_.swap(loaded_spelling);
+                removed_since_compact_ = 0;
+            }
+            else
+            {
+                // insert() keeps entries that already exist, and with them their spelling
+                while (!loaded.empty())
+                {
+                    store_type::insert_return_type inserted = data_.insert(loaded.extract(loaded.begin()));
+                    if (inserted.inserted && !loaded_spelling.empty())
+                    {
+                        auto spelled = loaded_spelling.find(inserted.position->first);
+                        if (spelled != loaded_spelling.end())
+                            spelling_.insert(loaded_spelling.extract(spelled));
+                    }
+                }
+            }
+        }
+        
         size_t size() const
         {
             return data_.size();
@@ -469,7 +1458,7 @@ namespace ini_parser
         // Section support (using dot notation: "section.key")
         bool has_section(const std::string& section) const
         {
-            std::string prefix = section + ".";
+            std::string prefix = section_prefix(section);
             for (const auto& pair : data_)
             {
                 if (pair.first.compare(0, prefix.length(), prefix) == 0)
@@ -481,7 +1470,7 @@ namespace ini_parser
         std::vector<std::string> get_section_keys(const std::string& section) const
         {
             std::vector<std::string> keys;
-            std::string prefix = section + ".";
+            std::string prefix = section_prefix(section);
             for (const auto& pair : data_)
             {
                 if (pair.first.compare(0, prefix.length(), prefix) == 0)
@@ -495,7 +1484,7 @@ namespace ini_parser
         std::map<std::string, config_value> get_section(const std::string& section) const
         {
             std::map<std::string, config_value> section_data;
-            std::string prefix = section + ".";
+            std::string prefix = section_prefix(section);
             for (const auto& pair : data_)
             {
                 if (pair.first.compare(0, prefix.length(), prefix) == 0)
@@ -507,158 +1496,821 @@ namespace ini_parser
         }
         
         // Iterator access
-        typedef std::map<std::string, config_value>::const_iterator const_iterator;
-        typedef std::map<std::string, config_value>::iterator iterator;
+        // In case-insensitive mode iteration yields the folded keys
+        typedef store_type::const_iterator const_iterator;
+        typedef store_type::iterator iterator;
         
         const_iterator begin() const { return data_.begin(); }
         const_iterator end() const { return data_.end(); }
         iterator begin() { return data_.begin(); }
         iterator end() { return data_.end(); }
+        
+        // All entries whose key starts with `prefix`, found by binary search
+        std::pair<const_iterator, const_iterator> prefix_range(const std::string& prefix) const
+        {
+            key_probe probe(prefix, case_insensitive_);
+            std::string_view folded = probe.view();
+            const_iterator first = data_.lower_bound(folded);
+            const_iterator last = first;
+            while (last != data_.end() && last->first.compare(0, folded.length(), folded) == 0)
+                ++last;
+            return std::make_pair(first, last);
+        }
+
+    protected:
+        // A key as stored: the caller's key itself, or its folded copy in an inline buffer
+        // (heap only for keys over 128 bytes) when folding is on and the key has upper case
+        class key_probe
+        {
+        public:
+            key_probe(std::string_view key, bool fold) : view_(key)
+            {
+                if (!fold || !has_ascii_upper(key))
+                    return;
+
+                char* folded = inline_;
+                if (key.size() > sizeof(inline_))
+                {
+                    overflow_.resize(key.size());
+                    folded = &overflow_[0];
+                }
+                fold_ascii(key.data(), key.size(), folded);
+                view_ = std::string_view(folded, key.size());
+            }
+
+            key_probe(const key_probe&) = delete;
+            key_probe& operator=(const key_probe&) = delete;
+
+            std::string_view view() const { return view_; }
+
+        private:
+            char inline_[128];
+            std::string overflow_;
+            std::string_view view_;
+        };
+
+        const_iterator find_key(std::string_view key) const
+        {
+            key_probe probe(key, case_insensitive_);
+            return data_.find(probe.view());
+        }
+
+        // Value slot for `key`, created if missing; records the original spelling of new folded keys
+        config_value& slot(const std::string& key)
+        {
+            if (!case_insensitive_ || !has_ascii_upper(key))
+                return data_[key];
+
+            std::string folded(key);
+            fold_ascii(folded.data(), folded.size(), &folded[0]);
+            auto it = data_.find(folded);
+            if (it == data_.end())
+            {
+                spelling_.emplace(folded, key);
+                it = data_.emplace(std::move(folded), config_value()).first;
+            }
+            return it->second;
+        }
+
+        // Original spelling of a stored key
+        const std::string& spelling(const std::string& stored_key) const
+        {
+            if (spelling_.empty())
+                return stored_key;
+            auto it = spelling_.find(stored_key);
+            return it != spelling_.end() ? it->second : stored_key;
+        }
+
+        // Visit every entry in key order under its original spelling. A folded section
+        // takes the spelling of its first key for all of its keys, so `[Database]` and
+        // `[database]` in one file still come out as one section.
+        template<typename Visit>
+        void for_each_spelled(Visit visit) const
+        {
+            if (spelling_.empty())
+            {
+                for (const auto& pair : data_)
+                    visit(pair.first, pair.second);
+                return;
+            }
+
+            // Folding keeps lengths, so the section ends at the same dot in both spellings
+            std::string section;
+            std::string spelled_section;
+            std::string spelled;
+            for (const auto& pair : data_)
+            {
+                const std::string& key = spelling(pair.first);
+                size_t dot_pos = pair.first.find('.');
+                if (dot_pos == std::string::npos)
+                {
+                    visit(key, pair.second);
+                    continue;
+                }
+                if (section.size() != dot_pos + 1 || pair.first.compare(0, dot_pos + 1, section) != 0)
+                {
+                    section.assign(pair.first, 0, dot_pos + 1);
+                    spelled_section.assign(key, 0, dot_pos + 1);
+                }
+                spelled.assign(spelled_section);
+                spelled.append(key, dot_pos + 1, std::string::npos);
+                visit(spelled, pair.second);
+            }
+        }
+
+        std::string section_prefix(const std::string& section) const
+        {
+            std::string prefix = section + ".";
+            if (case_insensitive_)
+                fold_ascii(prefix.data(), prefix.size(), &prefix[0]);
+            return prefix;
+        }
+
+    private:
+        // k-way merge of the keys in [lo, hi) across all sources (null bound = unbounded)
+        static store_type merge_range(const std::vector<const store_type*>& sources,
+                                      const std::string* lo, const std::string* hi, merge_strategy strategy)
+        {
+            typedef store_type::const_iterator cursor;
+            std::vector<cursor> pos(sources.size());
+            std::vector<cursor> last(sources.size());
+            std::vector<size_t> heap;
+            heap.reserve(sources.size());
+
+            for (size_t s = 0; s < sources.size(); ++s)
+            {
+                pos[s] = lo ? sources[s]->lower_bound(*lo) : sources[s]->begin();
+                last[s] = hi ? sources[s]->lower_bound(*hi) : sources[s]->end();
+                if (pos[s] != last[s])
+                    heap.push_back(s);
+            }
+
+            // Min-heap on the current key; equal keys surface in source order
+            auto later = [&pos](size_t a, size_t b)
+            {
+                int cmp = pos[a]->first.compare(pos[b]->first);
+                return cmp != 0 ? cmp > 0 : a > b;
+            };
+            std::make_heap(heap.begin(), heap.end(), later);
+
+            // Restore the heap after the top source advanced (one sift-down instead of pop + push)
+            auto sift_top = [&heap, &later]()
+            {
+                size_t i = 0;
+                size_t n = heap.size();
+                while (true)
+                {
+                    size_t child = 2 * i + 1;
+                    if (child >= n)
+                        break;
+                    if (child + 1 < n && later(heap[child], heap[child + 1]))
+                        ++child;
+                    if (!later(heap[i], heap[child]))
+                        break;
+                    std::swap(heap[i], heap[child]);
+                    i = child;
+                }
+            };
+
+            store_type out;
+            while (!heap.empty())
+            {
+                // Map nodes are stable, so the key stays valid while its source advances
+                const std::string& key = pos[heap.front()]->first;
+                const config_value* winner = nullptr;
+
+                do
+                {
+                    size_t s = heap.front();
+                    if (winner == nullptr || strategy == merge_strategy::OVERWRITE)
+                        winner = &pos[s]->second;
+                    if (++pos[s] == last[s])
+                    {
+                        heap.front() = heap.back();
+                        heap.pop_back();
+                    }
+                    if (!heap.empty())
+                        sift_top();
+                } while (!heap.empty() && pos[heap.front()]->first == key);
+
+                out.emplace_hint(out.end(), key, *winner);
+            }
+            return out;
+        }
     };
 
     // INI file parser (supports sections, key=value pairs, comments with # or ;)
     class ini_parser : public base_ini_parser
     {
+    public:
+        explicit ini_parser(key_case mode = key_case::SENSITIVE) : base_ini_parser(mode) {}
+
+    private:
+        // Resumable position of a parse over one buffer
+        struct parse_cursor
+        {
+            std::string current_section;
+            std::string full_key;
+            std::string spelled_key;
+            size_t line_number = 0;
+            size_t offset = 0;
+            size_t entries = 0;
+
+            // Offending line when parsing stops with INVALID_SYNTAX (view into the buffer)
+            std::string_view error_line;
+
+            // Keys written by this load, so PRESERVE only protects entries that existed before it
+            std::set<std::string> loaded_keys;
+        };
+
     public:
         bool load(const std::string &source, merge_strategy strategy = merge_strategy::OVERWRITE) override
         {
-            std::ifstream file(source);
-            if (!file.is_open())
+            expected<std::string, config_error_code> content = read_file(source);
+            if (!content)
             {
-                throw io_error("Failed to open INI file: " + source);
+                throw_read_error(content.error(), "INI file: " + source);
             }
-            
-            // If PRESERVE strategy, store existing data
-            std::map<std::string, config_value> backup_data;
-            if (strategy == merge_strategy::PRESERVE)
+
+            return load_from_buffer(content.value(), strategy);
+        }
+
+        // Parse INI text read from any input stream until EOF
+        bool load_from_stream(std::istream& input, merge_strategy strategy = merge_strategy::OVERWRITE)
+        {
+            expected<std::string, config_error_code> content = read_stream(input);
+            if (!content)
             {
-                backup_data = data_;
+                throw_read_error(content.error(), "INI data from stream");
             }
-            else
+
+            return load_from_buffer(content.value(), strategy);
+        }
+
+        // Parse INI text read from an open file descriptor (pipe, socket, memfd, ...).
+        // The descriptor is read until EOF and left open.
+        bool load_from_fd(int fd, merge_strategy strategy = merge_strategy::OVERWRITE)
+        {
+            int read_errno = 0;
+            expected<std::string, config_error_code> content = read_fd(fd, &read_errno);
+            if (!content)
             {
-                data_.clear();
+                std::string what = "INI data from fd " + std::to_string(fd);
+                if (read_errno != 0)
+                    what += std::string(": ") + std::strerror(read_errno);
+                throw_read_error(content.error(), what);
             }
-            
-            std::string line;
-            std::string current_section;
-            size_t line_number = 0;
-            
+
+            return load_from_buffer(content.value(), strategy);
+        }
+
+        // Parse INI text held in memory. Lines, sections and keys are tokenized as views
+        // into the buffer; only the stored keys and values are copied, so the buffer just
+        // has to stay valid for the duration of the call.
+        bool load_from_buffer(std::string_view buffer, merge_strategy strategy = merge_strategy::OVERWRITE)
+        {
+            parse_cursor cursor;
+            expected<size_t, config_error_code> loaded = load_buffer(buffer, strategy, cursor);
+            if (!loaded)
+            {
+                throw_parse_error(loaded.error(), cursor);
+            }
+
+            return true;
+        }
+
+        // Non-throwing variants of the loaders above. On success they return the number
+        // of key/value lines read; on failure the parser may hold a partial load, as with
+        // the throwing API.
+        expected<size_t, config_error_code> try_load(const std::string &source, merge_strategy strategy = merge_strategy::OVERWRITE) noexcept
+        {
+            expected<std::string, config_error_code> content = read_file(source);
+            if (!content)
+                return unexpected(content.error());
+            return try_load_from_buffer(content.value(), strategy);
+        }
+
+        expected<size_t, config_error_code> try_load_from_stream(std::istream& input, merge_strategy strategy = merge_strategy::OVERWRITE) noexcept
+        {
+            expected<std::string, config_error_code> content = read_stream(input);
+            if (!content)
+                return unexpected(content.error());
+            return try_load_from_buffer(content.value(), strategy);
+        }
+
+        expected<size_t, config_error_code> try_load_from_fd(int fd, merge_strategy strategy = merge_strategy::OVERWRITE) noexcept
+        {
+            expected<std::string, config_error_code> content = read_fd(fd);
+            if (!content)
+                return unexpected(content.error());
+            return try_load_from_buffer(content.value(), strategy);
+        }
+
+        expected<size_t, config_error_code> try_load_from_buffer(std::string_view buffer, merge_strategy strategy = merge_strategy::OVERWRITE) noexcept
+        {
+            parse_cursor cursor;
+            return load_buffer(buffer, strategy, cursor);
+        }
+
+        // Incremental load driven by an event loop.
+        // The file is read on a worker thread; each step() then does at most `budget`
+        // of work before returning control: parsing, installing the result, and
+        // freeing whatever it replaced. The parser must outlive the task.
+        //
+        // OVERWRITE: the parser keeps serving the previous configuration until the
+        // parsed one is swapped in whole. Writes made to the parser while the load is
+        // pending are discarded by that swap.
+        // PRESERVE: the parsed keys are merged into the live store over the final
+        // steps, so new keys appear as they are merged. Keys the parser already holds
+        // win, including ones set while the load is pending.
+        class load_task
+        {
+        public:
+            // Advance the load. Returns true once the parser holds the new data and the
+            // store it replaced has been freed. Rethrows io_error/parse_error raised
+            // while reading or parsing; the load has then failed for good, the parser
+            // keeps its previous data and every later step() rethrows the same error.
+            bool step(std::chrono::microseconds budget)
+            {
+                if (error_)
+                    std::rethrow_exception(error_);
+                if (phase_ == phase::DONE)
+                    return true;
+
+                std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + budget;
+                if (phase_ == phase::READING || phase_ == phase::PARSING)
+                {
+                    try
+                    {
+                        if (!parse(deadline))
+                            return false;
+                    }
+                    catch (...)
+                    {
+                        error_ = std::current_exception();
+                        throw;
+                    }
+                }
+
+                if (phase_ == phase::MERGING)
+                {
+                    if (!merge_staged(deadline))
+                        return false;
+                    phase_ = phase::FREEING;
+                }
+
+                if (!free_staged(deadline))
+                    return false;
+                phase_ = phase::DONE;
+                return true;
+            }
+
+            bool done() const { return phase_ == phase::DONE; }
+
+            bool failed() const { return static_cast<bool>(error_); }
+
+        private:
+            friend class ini_parser;
+
+            enum class phase
+            {
+                READING,
+                PARSING,
+                MERGING,
+                FREEING,
+                DONE
+            };
+
+            // Map nodes handled between clock reads while merging or freeing
+            static const size_t nodes_per_deadline_check = 256;
+
+            load_task(ini_parser& owner, std::future<std::string> content, merge_strategy strategy)
+                : owner_(&owner), strategy_(strategy), pending_content_(std::move(content)), phase_(phase::READING)
+            {
+            }
+
+            // Parse into staged_, a store of the file's keys alone (later duplicates win,
+            // as within one PRESERVE load), then install it
+            bool parse(std::chrono::steady_clock::time_point deadline)
+            {
+                if (phase_ == phase::READING)
+                {
+                    if (pending_content_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                        return false;
+                    content_ = pending_content_.get();
+                    phase_ = phase::PARSING;
+                }
+
+                expected<bool, config_error_code> finished =
+                    owner_->parse_lines(content_, cursor_, staged_, staged_spelling_, merge_strategy::OVERWRITE, deadline);
+                if (!finished)
+                    throw_parse_error(finished.error(), cursor_);
+                if (!finished.value())
+                    return false;
+                content_ = std::string();
+
+                if (strategy_ == merge_strategy::OVERWRITE)
+                {
+                    // The replaced store is left in staged_ to be freed
+                    owner_->data_.swap(staged_);
+                    owner_->spelling_.swap(staged_spelling_);
+                    owner_->removed_since_compact_ = 0;
+                    phase_ = phase::FREEING;
+                }
+                else
+                {
+                    phase_ = phase::MERGING;
+                }
+                return true;
+            }
+
+            // Move staged nodes into the parser; keys it already holds keep their value
+            bool merge_staged(std::chrono::steady_clock::time_point deadline)
+            {
+                size_t nodes = 0;
+                while (!staged_.empty())
+                {
+                    if (++nodes % nodes_per_deadline_check == 0 && std::chrono::steady_clock::now() >= deadline)
+                        return false;
+
+                    store_type::insert_return_type inserted = owner_->data_.insert(staged_.extract(staged_.begin()));
+                    if (inserted.inserted && !staged_spelling_.empty())
+                    {
+                        auto spelled = staged_spelling_.find(inserted.position->first);
+                        if (spelled != staged_spelling_.end())
+                            owner_->spelling_.insert(staged_spelling_.extract(spelled));
+                    }
+                }
+                return true;
+            }
+
+            // Free what is left in the staged stores a few nodes at a time
+            bool free_staged(std::chrono::steady_clock::time_point deadline)
+            {
+                size_t nodes = 0;
+                while (!staged_.empty() || !staged_spelling_.empty())
+                {
+                    if (++nodes % nodes_per_deadline_check == 0 && std::chrono::steady_clock::now() >= deadline)
+                        return false;
+
+                    if (!staged_.empty())
+                        staged_.erase(staged_.begin());
+                    if (!staged_spelling_.empty())
+                        staged_spelling_.erase(staged_spelling_.begin());
+                }
+                return true;
+            }
+
+            ini_parser* owner_;
+            merge_strategy strategy_;
+            std::future<std::string> pending_content_;
+            std::string content_;
+            phase phase_;
+            std::exception_ptr error_;
+            parse_cursor cursor_;
+            store_type staged_;
+            spelling_type staged_spelling_;
+        };
+
+        // Start a non-blocking load of `source`; drive it with load_task::step()
+        load_task async_load(const std::string &source, merge_strategy strategy = merge_strategy::OVERWRITE)
+        {
+            std::future<std::string> content = std::async(std::launch::async, [source]()
+            {
+                expected<std::string, config_error_code> data = read_file(source);
+                if (!data)
+                {
+                    throw_read_error(data.error(), "INI file: " + source);
+                }
+                return std::move(data).value();
+            });
+
+            return load_task(*this, std::move(content), strategy);
+        }
+
+        bool save(const std::string &destination) const override
+        {
+            expected<size_t, config_error_code> saved = try_save(destination);
+            if (!saved)
+            {
+                if (saved.error() == config_error_code::OUT_OF_MEMORY)
+                    throw std::bad_alloc();
+                if (saved.error() == config_error_code::FILE_OPEN_FAILED)
+                    throw io_error("Failed to open INI file for writing: " + destination);
+                throw io_error("Error writing INI file: " + destination);
+            }
+
+            return true;
+        }
+
+        // Non-throwing save; returns the number of keys written
+        expected<size_t, config_error_code> try_save(const std::string &destination) const noexcept
+        {
+            try
+            {
+                std::ofstream file(destination);
+                if (!file.is_open())
+                    return unexpected(config_error_code::FILE_OPEN_FAILED);
+
+                write_ini(file);
+                file.close();
+                if (!file)
+                    return unexpected(config_error_code::FILE_WRITE_FAILED);
+
+                return data_.size();
+            }
+            catch (const std::bad_alloc&)
+            {
+                return unexpected(config_error_code::OUT_OF_MEMORY);
+            }
+            catch (...)
+            {
+                return unexpected(config_error_code::FILE_WRITE_FAILED);
+            }
+        }
+
+        // Serialized INI text, as save() would write it
+        std::string to_ini_string() const
+        {
+            std::ostringstream out;
+            write_ini(out);
+            return out.str();
+        }
+
+        // Save without blocking the caller on disk I/O.
+        // The content is serialized immediately, so later changes to the parser are not
+        // included; the file is written on a worker thread. The future yields true or
+        // rethrows io_error.
+        std::future<bool> async_save(const std::string &destination) const
+        {
+            std::ostringstream out;
+            write_ini(out);
+
+            return std::async(std::launch::async, [destination](std::string text)
+            {
+                std::ofstream file(destination, std::ios::out | std::ios::binary);
+                if (!file.is_open())
+                {
+                    throw io_error("Failed to open INI file for writing: " + destination);
+                }
+
+                file.write(text.data(), static_cast<std::streamsize>(text.size()));
+                file.close();
+                if (!file)
+                {
+                    throw io_error("Error writing INI file: " + destination);
+                }
+                return true;
+            }, out.str());
+        }
+        
+    private:
+        // Tokenize lines from cursor.offset into `target` until the buffer is exhausted
+        // (true) or `deadline` passes (false, resume with the same cursor). Malformed
+        // input is reported as INVALID_SYNTAX with cursor.error_line set.
+        expected<bool, config_error_code> parse_lines(std::string_view buffer, parse_cursor& cursor, store_type& target, spelling_type& spellings,
+                                                      merge_strategy strategy, std::chrono::steady_clock::time_point deadline) const noexcept
+        {
+            // Reading the clock per line would dominate small lines
+            const size_t lines_per_deadline_check = 256;
+            const bool bounded = deadline != std::chrono::steady_clock::time_point::max();
+
+            size_t lines_this_call = 0;
+
             try
             {
-                while (std::getline(file, line))
+                while (cursor.offset < buffer.size())
                 {
-                    ++line_number;
-                    line = trim(line);
-                    
+                    if (bounded && ++lines_this_call % lines_per_deadline_check == 0 &&
+                        std::chrono::steady_clock::now() >= deadline)
+                    {
+                        return false;
+                    }
+
+                    size_t line_end = buffer.find('\n', cursor.offset);
+                    if (line_end == std::string_view::npos)
+                        line_end = buffer.size();
+
+                    std::string_view line = trim(buffer.substr(cursor.offset, line_end - cursor.offset));
+                    cursor.offset = line_end + 1;
+                    ++cursor.line_number;
+
                     // Skip empty lines and comments
                     if (line.empty() || is_comment(line))
                         continue;
-                    
+
                     // Check for section header
-                    std::string section;
+                    std::string_view section;
                     if (is_section_header(line, section))
                     {
-                        current_section = section;
+                        cursor.current_section.assign(section.data(), section.size());
                         continue;
                     }
-                    
+
                     // Parse key-value pair
-                    std::string key, value;
-                    if (parse_key_value(line, key, value))
+                    std::string_view key, value;
+                    if (!parse_key_value(line, key, value))
                     {
-                        std::string full_key = current_section.empty() ? key : current_section + "." + key;
-                        
-                        // Apply merge strategy
-                        if (strategy == merge_strategy::PRESERVE && backup_data.find(full_key) != backup_data.end())
-                        {
-                            data_[full_key] = backup_data[full_key];
-                        }
-                        else
-                        {
-                            data_[full_key] = parse_value(value);
-                        }
+                        cursor.error_line = line;
+                        return unexpected(config_error_code::INVALID_SYNTAX);
                     }
-                    else
+
+                    std::string& full_key = cursor.full_key;
+                    full_key.assign(cursor.current_section);
+                    if (!full_key.empty())
+                        full_key += '.';
+                    full_key.append(key.data(), key.size());
+                    ++cursor.entries;
+
+                    // Fold once here; a new key remembers how the file spelled it
+                    if (case_insensitive_ && has_ascii_upper(full_key))
+                    {
+                        cursor.spelled_key.assign(full_key);
+                        fold_ascii(full_key.data(), full_key.size(), &full_key[0]);
+                        if (target.find(full_key) == target.end())
+                            spellings.emplace(full_key, cursor.spelled_key);
+                    }
+
+                    // Apply merge strategy
+                    if (strategy == merge_strategy::PRESERVE)
                     {
-                        throw parse_error("Invalid INI syntax at line " + std::to_string(line_number) + ": " + line);
+                        if (target.find(full_key) != target.end() && cursor.loaded_keys.count(full_key) == 0)
+                            continue;
+                        cursor.loaded_keys.insert(full_key);
                     }
+
+                    target[full_key] = parse_value(std::string(value));
                 }
-                
-                file.close();
+
                 return true;
             }
-            catch (const std::exception& e)
+            catch (...)
             {
-                file.close();
-                throw parse_error("Error parsing INI file at line " + std::to_string(line_number) + ": " + e.what());
+                // Tokenizing never throws; only allocation can fail here
+                return unexpected(config_error_code::OUT_OF_MEMORY);
             }
         }
 
-        bool save(const std::string &destination) const override
+        // Load a whole buffer into data_ honouring the merge strategy
+        expected<size_t, config_error_code> load_buffer(std::string_view buffer, merge_strategy strategy, parse_cursor& cursor) noexcept
         {
-            std::ofstream file(destination);
-            if (!file.is_open())
+            if (strategy == merge_strategy::OVERWRITE)
             {
-                throw io_error("Failed to open INI file for writing: " + destination);
+                data_.clear();
+                spelling_.clear();
+                removed_since_compact_ = 0;
             }
-            
+
+            expected<bool, config_error_code> finished = parse_lines(buffer, cursor, data_, spelling_, strategy, std::chrono::steady_clock::time_point::max());
+            if (!finished)
+                return unexpected(finished.error());
+            return cursor.entries;
+        }
+
+        static expected<std::string, config_error_code> read_file(const std::string& source) noexcept
+        {
+            int fd = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return unexpected(config_error_code::FILE_OPEN_FAILED);
+
+            expected<std::string, config_error_code> content = read_fd(fd);
+            ::close(fd);
+            return content;
+        }
+
+        // read_errno, when given, receives errno from the read() that failed
+        static expected<std::string, config_error_code> read_fd(int fd, int* read_errno = nullptr) noexcept
+        {
             try
             {
-                // Group keys by section
-                std::map<std::string, std::vector<std::pair<std::string, config_value>>> sections;
-                
-                for (const auto& pair : data_)
+                std::string content;
+
+                struct stat st;
+                if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+                {
+                    content.reserve(static_cast<size_t>(st.st_size));
+                }
+
+                char chunk[64 * 1024];
+                while (true)
                 {
-                    size_t dot_pos = pair.first.find('.');
-                    if (dot_pos != std::string::npos)
+                    ssize_t n = ::read(fd, chunk, sizeof(chunk));
+                    if (n > 0)
                     {
-                        std::string section = pair.first.substr(0, dot_pos);
-                        std::string key = pair.first.substr(dot_pos + 1);
-                        sections[section].emplace_back(key, pair.second);
+                        content.append(chunk, static_cast<size_t>(n));
                     }
-                    else
+                    else if (n == 0)
                     {
-                        sections[""].emplace_back(pair.first, pair.second);
+                        return content;
                     }
-                }
-                
-                // Write global keys first (keys without section)
-                if (sections.find("") != sections.end() && !sections[""].empty())
-                {
-                    for (const auto& kv : sections[""])
+                    else if (errno != EINTR)
                     {
-                        write_key_value(file, kv.first, kv.second);
+                        if (read_errno != nullptr)
+                            *read_errno = errno;
+                        return unexpected(config_error_code::FILE_READ_FAILED);
                     }
-                    file << "\n";
                 }
-                
-                // Write sections
-                for (const auto& section_pair : sections)
+            }
+            catch (...)
+            {
+                return unexpected(config_error_code::OUT_OF_MEMORY);
+            }
+        }
+
+        static expected<std::string, config_error_code> read_stream(std::istream& input) noexcept
+        {
+            try
+            {
+                std::string content;
+                char chunk[64 * 1024];
+                while (input.read(chunk, sizeof(chunk)) || input.gcount() > 0)
                 {
-                    if (section_pair.first.empty())
-                        continue;
-                    
-                    file << "[" << section_pair.first << "]\n";
-                    for (const auto& kv : section_pair.second)
-                    {
-                        write_key_value(file, kv.first, kv.second);
-                    }
-                    file << "\n";
+                    content.append(chunk, static_cast<size_t>(input.gcount()));
                 }
-                
-                file.close();
-                return true;
+
+                if (input.bad())
+                    return unexpected(config_error_code::FILE_READ_FAILED);
+                return content;
             }
-            catch (const std::exception& e)
+            catch (const std::bad_alloc&)
             {
-                file.close();
-                throw io_error("Error writing INI file: " + std::string(e.what()));
+                return unexpected(config_error_code::OUT_OF_MEMORY);
+            }
+            catch (...)
+            {
+                // Streams with exceptions() enabled
+                return unexpected(config_error_code::FILE_READ_FAILED);
             }
         }
-        
-    private:
+
+        // Throwing side of the try_* API, keeping the historical exception messages
+        [[noreturn]] static void throw_read_error(config_error_code code, const std::string& source)
+        {
+            if (code == config_error_code::OUT_OF_MEMORY)
+                throw std::bad_alloc();
+            if (code == config_error_code::FILE_OPEN_FAILED)
+                throw io_error("Failed to open " + source);
+            throw io_error("Failed to read " + source);
+        }
+
+        [[noreturn]] static void throw_parse_error(config_error_code code, const parse_cursor& cursor)
+        {
+            if (code == config_error_code::OUT_OF_MEMORY)
+                throw std::bad_alloc();
+            std::string line_number = std::to_string(cursor.line_number);
+            throw parse_error("Error parsing INI file at line " + line_number + ": Invalid INI syntax at line " +
+                              line_number + ": " + std::string(cursor.error_line));
+        }
+
+        // Serialize all keys grouped by section
+        void write_ini(std::ostream& file) const
+        {
+            // Group keys by section
+            std::map<std::string, std::vector<std::pair<std::string, config_value>>> sections;
+            
+            // Case-insensitive stores write keys as they were first spelled
+            for_each_spelled([&](const std::string& full_key, const config_value& value)
+            {
+                size_t dot_pos = full_key.find('.');
+                if (dot_pos != std::string::npos)
+                {
+                    std::string section = full_key.substr(0, dot_pos);
+                    std::string key = full_key.substr(dot_pos + 1);
+                    sections[section].emplace_back(key, value);
+                }
+                else
+                {
+                    sections[""].emplace_back(full_key, value);
+                }
+            });
+            
+            // Write global keys first (keys without section)
+            if (sections.find("") != sections.end() && !sections[""].empty())
+            {
+                for (const auto& kv : sections[""])
+                {
+                    write_key_value(file, kv.first, kv.second);
+                }
+                file << "\n";
+            }
+            
+            // Write sections
+            for (const auto& section_pair : sections)
+            {
+                if (section_pair.first.empty())
+                    continue;
+                
+                file << "[" << section_pair.first << "]\n";
+                for (const auto& kv : section_pair.second)
+                {
+                    write_key_value(file, kv.first, kv.second);
+                }
+                file << "\n";
+            }
+        }
+
         // Trim whitespace from both ends of string
-        std::string trim(const std::string& str) const
+        std::string_view trim(std::string_view str) const
         {
             size_t start = 0;
             size_t end = str.length();
@@ -673,40 +2325,40 @@ namespace ini_parser
         }
         
         // Check if line is a comment
-        bool is_comment(const std::string& line) const
+        bool is_comment(std::string_view line) const
         {
             return !line.empty() && (line[0] == '#' || line[0] == ';');
         }
         
         // Check if line is a section header and extract section name
-        bool is_section_header(const std::string& line, std::string& section) const
+        bool is_section_header(std::string_view line, std::string_view& section) const
         {
             if (line.length() < 3 || line[0] != '[')
                 return false;
             
             size_t close_bracket = line.find(']');
-            if (close_bracket == std::string::npos)
+            if (close_bracket == std::string_view::npos)
                 return false;
             
             section = trim(line.substr(1, close_bracket - 1));
             
             // Validate section name (no dots allowed as they're used as separators)
-            if (section.empty() || section.find('.') != std::string::npos)
+            if (section.empty() || section.find('.') != std::string_view::npos)
                 return false;
             
             return true;
         }
         
         // Parse key=value or key:value pair
-        bool parse_key_value(const std::string& line, std::string& key, std::string& value) const
+        bool parse_key_value(std::string_view line, std::string_view& key, std::string_view& value) const
         {
             size_t separator_pos = line.find('=');
-            if (separator_pos == std::string::npos)
+            if (separator_pos == std::string_view::npos)
             {
                 separator_pos = line.find(':');
             }
             
-            if (separator_pos == std::string::npos || separator_pos == 0)
+            if (separator_pos == std::string_view::npos || separator_pos == 0)
                 return false;
             
             key = trim(line.substr(0, separator_pos));
@@ -740,28 +2392,26 @@ namespace ini_parser
             if (lower_value == "null" || lower_value == "nil" || lower_value == "none")
                 return config_value();
             
-            // Try to parse as number
-            try
+            // Try to parse as number (from_chars reports failure without throwing)
+            const char* first = value_str.data();
+            const char* last = first + value_str.length();
+            if (*first == '+' && last - first > 1 && first[1] != '-')
+                ++first; // stoi/stod accept an explicit plus sign, from_chars does not
+            
+            // Check if it contains a decimal point
+            if (value_str.find('.') != std::string::npos)
             {
-                // Check if it contains a decimal point
-                if (value_str.find('.') != std::string::npos)
-                {
-                    size_t idx;
-                    double d = std::stod(value_str, &idx);
-                    if (idx == value_str.length())
-                        return config_value(d);
-                }
-                else
-                {
-                    size_t idx;
-                    int i = std::stoi(value_str, &idx);
-                    if (idx == value_str.length())
-                        return config_value(i);
-                }
+                double d;
+                std::from_chars_result result = std::from_chars(first, last, d);
+                if (result.ec == std::errc() && result.ptr == last)
+                    return config_value(d);
             }
-            catch (...)
+            else
             {
-                // Not a number, treat as string
+                int i;
+                std::from_chars_result result = std::from_chars(first, last, i);
+                if (result.ec == std::errc() && result.ptr == last)
+                    return config_value(i);
             }
             
             // Default to string
@@ -780,7 +2430,7 @@ namespace ini_parser
         }
         
         // Write key-value pair to file
-        void write_key_value(std::ofstream& file, const std::string& key, const config_value& value) const
+        void write_key_value(std::ostream& file, const std::string& key, const config_value& value) const
         {
             file << key << " = ";
             
@@ -0,0 +1,291 @@
+#include "ini_parser.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <getopt.h>
+#include <sys/mman.h>
+
+/*
+ * ini-query: bulk key lookups over many INI files.
+ *
+ *   ini-query [-k KEY]... [-p PREFIX]... [-o plain|tsv|json] [-j THREADS] [-l LIST] [FILE]...
+ *
+ * Each file is mapped read-only and parsed straight from the mapping; files are
+ * spread over worker threads and results are printed in input order. Within a file
+ * each matching key is printed once, in key order, however many -k/-p options
+ * match it. LIST names a file holding one path per line ("-" for stdin), for sweeps
+ * too large for argv.
+ */
+
+namespace
+{
+    enum class output_format
+    {
+        PLAIN,
+        TSV,
+        JSON
+    };
+
+    struct query_options
+    {
+        std::vector<std::string> keys;
+        std::vector<std::string> prefixes;
+        output_format format = output_format::PLAIN;
+        unsigned threads = 0;
+    };
+
+    // Read-only mapping of a whole file
+    class mapped_file
+    {
+    public:
+        explicit mapped_file(const std::string& path) : data_(nullptr), size_(0), ok_(false)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return;
+
+            struct stat st;
+            if (::fstat(fd, &st) == 0)
+            {
+                size_ = static_cast<size_t>(st.st_size);
+                if (size_ == 0)
+                {
+                    ok_ = true;
+                }
+                else
+                {
+                    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (addr != MAP_FAILED)
+                    {
+                        data_ = static_cast<const char*>(addr);
+                        ok_ = true;
+                    }
+                }
+            }
+            ::close(fd);
+        }
+
+        ~mapped_file()
+        {
+            if (data_ != nullptr)
+                ::munmap(const_cast<char*>(data_), size_);
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        bool ok() const { return ok_; }
+        std::string_view view() const { return std::string_view(data_, data_ != nullptr ? size_ : 0); }
+
+    private:
+        const char* data_;
+        size_t size_;
+        bool ok_;
+    };
+
+    void append_result(std::string& out, output_format format, const std::string& file,
+                       const std::string& key, const ini_parser::config_value& value, bool& first)
+    {
+        switch (format)
+        {
+            case output_format::PLAIN:
+                out += file + ": " + key + " = " + (value.is_array() || value.is_object() ? "[complex value]" : value.as_string()) + "\n";
+                break;
+            case output_format::TSV:
+                out += file + "\t" + key + "\t" + (value.is_array() || value.is_object() ? "" : value.as_string()) + "\n";
+                break;
+            case output_format::JSON:
+                out += first ? "" : ",";
+                ini_parser::append_json_string(out, key);
+                out += ':';
+                value.to_json(out);
+                break;
+        }
+        first = false;
+    }
+
+    // Query one file; returns false (with a message in `error`) if it cannot be read or parsed
+    bool query_file(const std::string& path, const query_options& options, std::string& out, std::string& error)
+    {
+        mapped_file file(path);
+        if (!file.ok())
+        {
+            error = "cannot read file";
+            return false;
+        }
+
+        ini_parser::ini_parser parser;
+        ini_parser::expected<size_t, ini_parser::config_error_code> loaded = parser.try_load_from_buffer(file.view());
+        if (!loaded)
+        {
+            error = loaded.error() == ini_parser::config_error_code::INVALID_SYNTAX ? "invalid INI syntax" : "out of memory";
+            return false;
+        }
+
+        // A key named by -k and also under a -p prefix (or two prefixes) is written once
+        std::map<std::string, ini_parser::config_value> matches;
+        for (const std::string& key : options.keys)
+        {
+            ini_parser::expected<ini_parser::config_value, ini_parser::config_error_code> value = parser.try_get(key);
+            if (value)
+                matches.emplace(key, std::move(value.value()));
+        }
+
+        for (const std::string& prefix : options.prefixes)
+        {
+            auto range = parser.prefix_range(prefix);
+            for (auto it = range.first; it != range.second; ++it)
+                matches.emplace(it->first, it->second);
+        }
+
+        bool first = true;
+        if (options.format == output_format::JSON)
+        {
+            out += "{\"file\":";
+            ini_parser::append_json_string(out, path);
+            out += ",\"values\":{";
+        }
+
+        for (const auto& match : matches)
+            append_result(out, options.format, path, match.first, match.second, first);
+
+        if (options.format == output_format::JSON)
+            out += "}}\n";
+
+        return true;
+    }
+
+    bool read_file_list(const std::string& list, std::vector<std::string>& files)
+    {
+        std::ifstream list_file;
+        std::istream* input = &std::cin;
+        if (list != "-")
+        {
+            list_file.open(list);
+            if (!list_file.is_open())
+                return false;
+            input = &list_file;
+        }
+
+        std::string line;
+        while (std::getline(*input, line))
+        {
+            if (!line.empty())
+                files.push_back(line);
+        }
+        return true;
+    }
+
+    void print_usage()
+    {
+        std::cerr << "Usage: ini-query [-k KEY]... [-p PREFIX]... [-o plain|tsv|json] [-j THREADS] [-l LIST] [FILE]...\n"
+                  << "  -k KEY     print KEY (section.key) if present\n"
+                  << "  -p PREFIX  print every key starting with PREFIX\n"
+                  << "  -o FORMAT  output format: plain (default), tsv, json (one object per file)\n"
+                  << "  -j THREADS worker threads (default: all cores)\n"
+                  << "  -l LIST    read file paths from LIST, one per line (- for stdin)\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    query_options options;
+    std::vector<std::string> files;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "k:p:o:j:l:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'k':
+                options.keys.push_back(optarg);
+                break;
+            case 'p':
+                options.prefixes.push_back(optarg);
+                break;
+            case 'o':
+            {
+                std::string format = optarg;
+                if (format == "plain")
+                    options.format = output_format::PLAIN;
+                else if (format == "tsv")
+                    options.format = output_format::TSV;
+                else if (format == "json")
+                    options.format = output_format::JSON;
+                else
+                {
+                    std::cerr << "ini-query: unknown output format: " << format << std::endl;
+                    return 2;
+                }
+                break;
+            }
+            case 'j':
+                options.threads = static_cast<unsigned>(std::strtoul(optarg, nullptr, 10));
+                break;
+            case 'l':
+                if (!read_file_list(optarg, files))
+                {
+                    std::cerr << "ini-query: cannot read file list: " << optarg << std::endl;
+                    return 2;
+                }
+                break;
+            default:
+                print_usage();
+                return 2;
+        }
+    }
+
+    for (int i = optind; i < argc; ++i)
+        files.push_back(argv[i]);
+
+    if (files.empty() || (options.keys.empty() && options.prefixes.empty()))
+    {
+        print_usage();
+        return 2;
+    }
+
+    unsigned threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, files.size()));
+
+    // Workers claim files by index; output is buffered per file and printed in input order
+    std::vector<std::string> outputs(files.size());
+    std::vector<std::string> errors(files.size());
+    std::atomic<size_t> next_file(0);
+
+    auto worker = [&]()
+    {
+        size_t index;
+        while ((index = next_file.fetch_add(1, std::memory_order_relaxed)) < files.size())
+        {
+            query_file(files[index], options, outputs[index], errors[index]);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread& thread : pool)
+        thread.join();
+
+    int status = 0;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        if (!errors[i].empty())
+        {
+            std::cerr << "ini-query: " << files[i] << ": " << errors[i] << std::endl;
+            status = 1;
+            continue;
+        }
+        std::fwrite(outputs[i].data(), 1, outputs[i].size(), stdout);
+    }
+
+    return status;
+}
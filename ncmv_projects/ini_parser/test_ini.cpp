@@ -1,7 +1,17 @@
 #include "ini_parser.h"
+#include "ini_batch_io.h"
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
 
 int main()
 {
@@ -67,5 +77,158 @@ int main()
         std::cout << "Failed to save updated INI file." << std::endl;
     }
 
+    const std::string INI_TEXT = "[Network]\nhost = 10.0.0.1\nport = 9000\n";
+    ini_parser::ini_parser buffer_parser;
+    buffer_parser.load_from_buffer(INI_TEXT);
+    std::cout << "Buffer Network Host: " << buffer_parser.get("Network.host").as_string()
+              << ", Port: " << buffer_parser.get("Network.port").as_int() << std::endl;
+
+    // A read error names the errno of the read() that failed
+    int dir_fd = ::open(".", O_RDONLY | O_DIRECTORY);
+    try
+    {
+        ini_parser::ini_parser fd_parser;
+        fd_parser.load_from_fd(dir_fd);
+        std::cout << "Directory fd unexpectedly loaded" << std::endl;
+    }
+    catch (const ini_parser::io_error& e)
+    {
+        std::cout << "Directory fd: " << e.what() << std::endl;
+    }
+    ::close(dir_fd);
+
+    ini_parser::ini_parser folded_parser(ini_parser::key_case::INSENSITIVE);
+    folded_parser.load(INI_FILE);
+    std::cout << "Case-insensitive Database Host: " << folded_parser.get("DATABASE.HOST").as_string() << std::endl;
+
+    // One folded section keeps one spelling, whichever header its keys came from
+    ini_parser::ini_parser spelled_parser(ini_parser::key_case::INSENSITIVE);
+    spelled_parser.load_from_buffer("[Database]\nhost = db1\n[database]\nuser = admin\n");
+    std::cout << "Case-insensitive sections as JSON: " << spelled_parser.to_json() << std::endl;
+
+    // A PRESERVE import leaves keys already held alone, spelling included
+    ini_parser::ini_parser preserved_parser(ini_parser::key_case::INSENSITIVE);
+    preserved_parser.load_from_buffer("[cache]\nsize = 64\n");
+    preserved_parser.from_json("{\"CACHE.SIZE\":\"128\",\"Cache.TTL\":\"30\"}", ini_parser::merge_strategy::PRESERVE);
+    std::cout << "After PRESERVE JSON import: " << preserved_parser.to_json() << std::endl;
+
+    // merge_all() matches merge() applied to each parser in turn, for either strategy
+    std::vector<ini_parser::ini_parser> layers(3);
+    layers[0].load_from_buffer("[Layer]\nname = base\nbase_only = 1\nshared = base\n");
+    layers[1].load_from_buffer("[Layer]\nname = site\nshared = site\n");
+    layers[2].load_from_buffer("[Layer]\nname = host\nhost_only = 3\n");
+    std::vector<const ini_parser::base_ini_parser*> layer_views;
+    for (const ini_parser::ini_parser& layer : layers)
+        layer_views.push_back(&layer);
+    for (ini_parser::merge_strategy strategy : {ini_parser::merge_strategy::OVERWRITE, ini_parser::merge_strategy::PRESERVE})
+    {
+        ini_parser::ini_parser all_at_once;
+        all_at_once.set("Layer.name", ini_parser::config_value("local"));
+        ini_parser::ini_parser one_by_one = all_at_once;
+        all_at_once.merge_all(layer_views, strategy);
+        for (const ini_parser::ini_parser& layer : layers)
+            one_by_one.merge(layer, strategy);
+        std::cout << "merge_all " << (strategy == ini_parser::merge_strategy::OVERWRITE ? "OVERWRITE" : "PRESERVE")
+                  << " over 3 parsers: " << all_at_once.to_json() << " (same as merge(): "
+                  << (all_at_once.to_json() == one_by_one.to_json() ? "yes" : "no") << ")" << std::endl;
+    }
+    ini_parser::ini_parser unmerged;
+    unmerged.set("Layer.name", ini_parser::config_value("local"));
+    unmerged.merge_all({});
+    std::cout << "merge_all over no parsers: " << unmerged.to_json() << std::endl;
+
+    ini_parser::ini_parser async_parser;
+    ini_parser::ini_parser::load_task task = async_parser.async_load(INI_FILE);
+    while (!task.step(std::chrono::microseconds(200)))
+    {
+        // An event loop would service other work here
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::cout << "Async load finished with " << async_parser.size() << " keys" << std::endl;
+
+    // PRESERVE merges into the live store; keys held already, even ones set mid-load, win
+    ini_parser::ini_parser preserve_parser;
+    preserve_parser.set("Database.port", 1);
+    ini_parser::ini_parser::load_task preserve_task = preserve_parser.async_load(INI_FILE, ini_parser::merge_strategy::PRESERVE);
+    preserve_parser.set("Logging.file", ini_parser::config_value("/tmp/preserve.log"));
+    while (!preserve_task.step(std::chrono::microseconds(200)))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::cout << "Async PRESERVE load: " << preserve_parser.size() << " keys, Database.port "
+              << preserve_parser.get("Database.port").as_int() << ", Logging.file "
+              << preserve_parser.get("Logging.file").as_string() << std::endl;
+
+    // A failed load stays failed and leaves the parser as it was
+    ini_parser::ini_parser failing_parser;
+    failing_parser.set("Kept.key", 1);
+    ini_parser::ini_parser::load_task failing_task = failing_parser.async_load("missing.ini");
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        try
+        {
+            while (!failing_task.step(std::chrono::microseconds(200)))
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            std::cout << "Async load of missing.ini unexpectedly finished" << std::endl;
+        }
+        catch (const ini_parser::io_error& e)
+        {
+            std::cout << "Async load of missing.ini failed (step " << attempt + 1 << "): " << e.what()
+                      << ", parser keeps " << failing_parser.size() << " key" << std::endl;
+        }
+    }
+    async_parser.async_save("async_sample.ini").get();
+
+    // ini-query writes a key matched by both -k and -p once
+    if (FILE* query = ::popen("./ini-query -k Database.port -p Database.p -p Database. -o json sample.ini", "r"))
+    {
+        std::string query_output;
+        char query_chunk[512];
+        size_t n;
+        while ((n = std::fread(query_chunk, 1, sizeof(query_chunk), query)) > 0)
+            query_output.append(query_chunk, n);
+        int query_status = ::pclose(query);
+        std::cout << "ini-query overlapping -k/-p (exit " << query_status << "): " << query_output;
+    }
+
+    // Batches larger than the descriptor limit are processed in chunks
+    char batch_dir[] = "/tmp/test_ini_XXXXXX";
+    struct rlimit fd_limit;
+    if (::mkdtemp(batch_dir) != nullptr && ::getrlimit(RLIMIT_NOFILE, &fd_limit) == 0)
+    {
+        const size_t BATCH_FILES = 300;
+        std::vector<std::string> batch_paths;
+        std::vector<ini_parser::ini_parser> batch_parsers(BATCH_FILES);
+        std::vector<const ini_parser::ini_parser*> batch_sources;
+        for (size_t i = 0; i < BATCH_FILES; ++i)
+        {
+            batch_paths.push_back(std::string(batch_dir) + "/" + std::to_string(i) + ".ini");
+            batch_parsers[i].set("Batch.index", ini_parser::config_value(std::to_string(i)));
+            batch_sources.push_back(&batch_parsers[i]);
+        }
+
+        struct rlimit lowered = fd_limit;
+        lowered.rlim_cur = 64;
+        ::setrlimit(RLIMIT_NOFILE, &lowered);
+        for (ini_parser::batch_io::backend mode : {ini_parser::batch_io::backend::BLOCKING, ini_parser::batch_io::backend::AUTO})
+        {
+            ini_parser::batch_io io(mode);
+            std::vector<ini_parser::ini_parser> loaded(BATCH_FILES);
+            size_t saved = 0;
+            size_t matched = 0;
+            for (const auto& result : ini_parser::save_files(io, batch_paths, batch_sources, false))
+                saved += result.has_value();
+            std::vector<ini_parser::expected<size_t, ini_parser::config_error_code>> load_results =
+                ini_parser::load_files(io, batch_paths, loaded);
+            for (size_t i = 0; i < BATCH_FILES; ++i)
+                matched += load_results[i].has_value() && loaded[i].get("Batch.index").as_string() == std::to_string(i);
+            std::cout << "Batch I/O (" << (io.uses_io_uring() ? "io_uring" : "blocking") << ") under a 64 fd limit: saved "
+                      << saved << "/" << BATCH_FILES << ", loaded " << matched << "/" << BATCH_FILES << std::endl;
+        }
+        ::setrlimit(RLIMIT_NOFILE, &fd_limit);
+
+        for (const std::string& path : batch_paths)
+            ::unlink(path.c_str());
+        ::rmdir(batch_dir);
+    }
+
     return 0;
 }
\ No newline at end of file